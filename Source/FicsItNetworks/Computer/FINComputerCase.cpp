@@ -18,7 +18,7 @@
 AFINComputerCase::AFINComputerCase() {
 	NetworkConnector = CreateDefaultSubobject<UFINAdvancedNetworkConnectionComponent>("NetworkConnector");
 	NetworkConnector->SetupAttachment(RootComponent);
-	NetworkConnector->OnNetworkSignal.AddDynamic(this, &AFINComputerCase::HandleSignal);
+	NetworkConnector->OnNetworkSignalNative.BindUObject(this, &AFINComputerCase::HandleSignal);
 	
 	Panel = CreateDefaultSubobject<UFINModuleSystemPanel>("Panel");
 	Panel->SetupAttachment(RootComponent);
@@ -34,12 +34,8 @@ AFINComputerCase::AFINComputerCase() {
 	Speaker = CreateDefaultSubobject<UAudioComponent>("Speaker");
 	Speaker->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
 	
-	mFactoryTickFunction.bCanEverTick = true;
-	mFactoryTickFunction.bStartWithTickEnabled = true;
-	mFactoryTickFunction.bRunOnAnyThread = true;
-	mFactoryTickFunction.bAllowTickOnDedicatedServer = true;
-
-	if (HasAuthority()) mFactoryTickFunction.SetTickFunctionEnable(true);
+	// the kernel gets ticked by the kernel scheduler of the computer subsystem
+	mFactoryTickFunction.bCanEverTick = false;
 
 	kernel = new FicsItKernel::KernelSystem();
 	kernel->setNetwork(new FicsItKernel::Network::NetworkController());
@@ -58,8 +54,9 @@ AFINComputerCase::~AFINComputerCase() {
 
 void AFINComputerCase::Serialize(FArchive& Ar) {
 	Super::Serialize(Ar);
-	if (Ar.IsSaveGame() && AFINComputerSubsystem::GetComputerSubsystem(this)->Version >= EFINCustomVersion::FINSignalStorage) {
-		kernel->Serialize(Ar, KernelState);
+	const int32 Version = Ar.IsSaveGame() ? AFINComputerSubsystem::GetComputerSubsystem(this)->Version : 0;
+	if (Ar.IsSaveGame() && Version >= EFINCustomVersion::FINSignalStorage) {
+		kernel->Serialize(Ar, KernelState, Version);
 	}
 }
 
@@ -68,6 +65,8 @@ void AFINComputerCase::BeginPlay() {
 	
 	DataStorage->Resize(2);
 
+	kernel->getNetwork()->setMaxSignalCount(FMath::Max(MaxSignalCount, 1));
+
 	// load floppy
 	AFINFileSystemState* state = nullptr;
 	FInventoryStack stack;
@@ -83,16 +82,18 @@ void AFINComputerCase::BeginPlay() {
 		Floppy = state;
 		if (Floppy) kernel->addDrive(Floppy);
 	}
-}
 
-void AFINComputerCase::TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction) {
-	if (kernel) kernel->handleFutures();
+	if (HasAuthority()) AFINComputerSubsystem::GetComputerSubsystem(this)->AddComputer(this);
 }
 
-void AFINComputerCase::Factory_Tick(float dt) {
-	KernelTickTime += dt;
-	if (KernelTickTime > 10.0) KernelTickTime = 10.0;
+void AFINComputerCase::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	AFINComputerSubsystem* Subsystem = AFINComputerSubsystem::GetComputerSubsystem(this);
+	if (Subsystem) Subsystem->RemoveComputer(this);
+
+	Super::EndPlay(EndPlayReason);
+}
 
+void AFINComputerCase::TickKernel(float dt) {
 	float KernelTicksPerSec = 1.0;
 	if (Processors.Num() >= 1) KernelTicksPerSec = Processors.begin().ElementIt->Value->KernelTicksPerSecond;
 
@@ -126,6 +127,7 @@ void AFINComputerCase::PostLoadGame_Implementation(int32 saveVersion, int32 game
 }
 
 void AFINComputerCase::PreSaveGame_Implementation(int32 gameVersion, int32 engineVersion) {
+	MaxSignalCount = kernel->getNetwork()->getMaxSignalCount();
 	kernel->PreSerialize(KernelState, false);
 }
 
@@ -347,8 +349,8 @@ void AFINComputerCase::WriteSerialInput(const FString& str) {
 	}
 }
 
-void AFINComputerCase::HandleSignal(const FFINDynamicStructHolder& signal, const FFINNetworkTrace& sender) {
-	if (kernel) kernel->getNetwork()->pushSignal(signal, sender);
+bool AFINComputerCase::HandleSignal(const FFINDynamicStructHolder& signal, const FFINNetworkTrace& sender) {
+	return kernel && kernel->getNetwork()->pushSignal(signal, sender);
 }
 
 void AFINComputerCase::OnDriveUpdate(bool added, AFINFileSystemState* drive) {
@@ -45,6 +45,14 @@ public:
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, SaveGame, Category="ComputerCase")
 	int LastTabIndex = 0;
+
+	/**
+	 * The max amount of signals the signal queue of the kernel can hold.
+	 * The queue storage is charged to the kernel memory.
+	 * Scripts can change it per computer, it gets updated from the kernel when saving.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, SaveGame, Category="ComputerCase")
+	int32 MaxSignalCount = 32;
 	
 	UPROPERTY()
 	FKernelSystemSerializationInfo KernelState;
@@ -70,6 +78,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
 	TSet<AFINComputerScreen*> Screens;
 
+	/**
+	 * The time in seconds the kernel has not yet ticked for.
+	 * Gets accumulated by the kernel scheduler of the computer subsystem.
+	 */
 	float KernelTickTime = 0.0;
 
 	AFINComputerCase();
@@ -81,12 +93,16 @@ public:
 
 	// Begin AActor
 	virtual void BeginPlay() override;
-	virtual void TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	// End AActor
 
-	// Begin AFGBuildable
-	virtual void Factory_Tick(float dt) override;
-	// End AFGBuildable
+	/**
+	 * Ticks the kernel as often as the processor allows for the accumulated kernel tick time.
+	 * Gets called by the kernel scheduler, possibly from a worker thread.
+	 *
+	 * @param[in]	dt	the time in seconds since the last frame
+	 */
+	void TickKernel(float dt);
 
 	// Begin IFGSaveInterface
 	virtual bool ShouldSave_Implementation() const override;
@@ -170,8 +186,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Network|Computer")
 	FString GetSerialOutput();
 
-	UFUNCTION()
-	void HandleSignal(const FFINDynamicStructHolder& signal, const FFINNetworkTrace& sender);
+	/**
+	 * Queues the given signal in the kernel.
+	 *
+	 * @return	false if the signal got dropped
+	 */
+	bool HandleSignal(const FFINDynamicStructHolder& signal, const FFINNetworkTrace& sender);
 
 private:
 	UPROPERTY(SaveGame)
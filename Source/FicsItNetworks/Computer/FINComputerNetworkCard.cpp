@@ -1,5 +1,6 @@
 ﻿#include "FINComputerNetworkCard.h"
 
+#include "Network/FINAnyNetworkValue.h"
 #include "Network/FINNetworkCircuit.h"
 #include "Network/FINVariadicParameterList.h"
 #include "Network/Signals/FINSignalListener.h"
@@ -9,6 +10,7 @@ void AFINComputerNetworkCard::BeginPlay() {
 	if (!bIdCreated) {
 		ID = FGuid::NewGuid();
 		bIdCreated = true;
+		if (Circuit) Circuit->UpdateComponent(this);
 	}
 
 	// setup circuit
@@ -28,6 +30,7 @@ FString AFINComputerNetworkCard::GetNick_Implementation() const {
 
 void AFINComputerNetworkCard::SetNick_Implementation(const FString& nick) {
 	Nick = nick;
+	if (Circuit) Circuit->UpdateComponent(this);
 }
 
 bool AFINComputerNetworkCard::HasNick_Implementation(const FString& nick) {
@@ -56,58 +59,101 @@ void AFINComputerNetworkCard::SetCircuit_Implementation(UFINNetworkCircuit * Cir
 	this->Circuit = Circuit;
 }
 
-void AFINComputerNetworkCard::NotifyNetworkUpdate_Implementation(int Type, const TSet<UObject*>& Nodes) {}
+void AFINComputerNetworkCard::NotifyNetworkUpdate_Implementation(int Type, const TSet<FGuid>& Components) {}
 
 bool AFINComputerNetworkCard::IsPortOpen(int Port) {
 	return OpenPorts.Contains(Port);
 }
 
-void AFINComputerNetworkCard::HandleMessage(FFINNetworkTrace Sender, int Port, const TFINDynamicStruct<FFINParameterList>& Data) {
+TSet<int> AFINComputerNetworkCard::GetOpenPorts() {
+	return OpenPorts;
+}
+
+bool AFINComputerNetworkCard::HandleMessage(FFINNetworkTrace Sender, int Port, const TFINDynamicStruct<FFINParameterList>& Data) {
+	if (Listeners.Num() < 1) return false;
+	if (MessageQueue->Count.load(std::memory_order_relaxed) >= MaxQueuedMessages) return false;
+	const int64 Size = FFINNetworkMessageSignal::CalculateSize(Data);
+	if (Size > MaxMessageSize) return false;
+	
+	// the signal is immutable, so all listeners can share the same instance and the same queue slot
+	const TFINDynamicStruct<FFINSignal> Signal = FFINNetworkMessageSignal(IFINNetworkComponent::Execute_GetID(*Sender), Port, Data, Size, MakeShared<FFINNetworkMessageTicket, ESPMode::ThreadSafe>(MessageQueue));
+	// the message only counts as delivered if at least one listener queued it, otherwise the ticket gets released with the signal
+	bool bQueued = false;
 	for (const FFINNetworkTrace& Listener : Listeners) {
-		Cast<IFINSignalListener>(*Listener)->HandleSignal(FFINNetworkMessageSignal(IFINNetworkComponent::Execute_GetID(*Sender), Port, Data), Listener.Reverse());
+		IFINSignalListener* SignalListener = Cast<IFINSignalListener>(*Listener);
+		if (SignalListener && SignalListener->HandleSignal(Signal, Listener.Reverse())) bQueued = true;
 	}
+	return bQueued;
 }
 
 void AFINComputerNetworkCard::netFunc_open(int port) {
 	if (port < 0 || port > 1000) return;
-	if (!OpenPorts.Contains(port)) OpenPorts.Add(port);
+	if (OpenPorts.Contains(port)) return;
+	OpenPorts.Add(port);
+	if (Circuit) Circuit->UpdateComponent(this);
 }
 
 void AFINComputerNetworkCard::netFunc_close(int port) {
-	OpenPorts.Remove(port);
+	if (OpenPorts.Remove(port) > 0 && Circuit) Circuit->UpdateComponent(this);
 }
 
 void AFINComputerNetworkCard::netFunc_closeAll() {
 	OpenPorts.Empty();
+	if (Circuit) Circuit->UpdateComponent(this);
 }
 
-void AFINComputerNetworkCard::netFunc_send(FString receiver, int port, FFINDynamicStructHolder args) {
+bool AFINComputerNetworkCard::netFunc_send(FString receiver, int port, FFINDynamicStructHolder args) {
 	FFINVoidValueReader VoidReader;
 	int argCount = args.Get<FFINParameterList>() >> VoidReader;
-	if (port < 0 || port > 10000 || argCount > 7) return;
+	if (port < 0 || port > 10000 || argCount > 7 || !Circuit) return false;
 
 	FGuid receiverID;
 	FGuid::Parse(receiver, receiverID);
 	UObject* Obj = Circuit->FindComponent(receiverID, nullptr).GetObject();
 	IFINNetworkMessageInterface* NetMsgI = Cast<IFINNetworkMessageInterface>(Obj);
-	if (NetMsgI) {
-		if (NetMsgI->IsPortOpen(port)) NetMsgI->HandleMessage(FFINNetworkTrace(Obj) / this, port, args);
-	}
+	if (!NetMsgI || !NetMsgI->IsPortOpen(port)) return false;
+	return NetMsgI->HandleMessage(FFINNetworkTrace(Obj) / this, port, args);
 }
 
-void AFINComputerNetworkCard::netFunc_broadcast(int port, FFINDynamicStructHolder args) {
+int AFINComputerNetworkCard::netFunc_broadcast(int port, FFINDynamicStructHolder args) {
 	FFINVoidValueReader VoidReader;
 	int argCount = args.Get<FFINParameterList>() >> VoidReader;
-	if (port < 0 || port > 10000 || argCount > 7) return;
-	for (UObject* Component : GetCircuit_Implementation()->GetComponents()) {
+	if (port < 0 || port > 10000 || argCount > 7 || !Circuit) return 0;
+	const TArray<TWeakObjectPtr<UObject>> PortListeners = Circuit->GetPortListeners(port);
+	if (PortListeners.Num() < 1) return 0;
+
+	// all receivers share the same argument payload
+	const TFINDynamicStruct<FFINParameterList> Data = args;
+	int Accepted = 0;
+	for (const TWeakObjectPtr<UObject>& Listener : PortListeners) {
+		UObject* Component = Listener.Get();
 		IFINNetworkMessageInterface* NetMsgI = Cast<IFINNetworkMessageInterface>(Component);
 		if (NetMsgI && NetMsgI->IsPortOpen(port)) {
-			NetMsgI->HandleMessage(FFINNetworkTrace(Component) / this, port, args);
+			if (NetMsgI->HandleMessage(FFINNetworkTrace(Component) / this, port, Data)) ++Accepted;
 		}
 	}
+	return Accepted;
 }
 
-FFINNetworkMessageSignal::FFINNetworkMessageSignal(FGuid Sender, int Port, const TFINDynamicStruct<FFINParameterList>& Data) : FFINSignal("NetworkMessage"), Sender(Sender), Port(Port), Data(Data) {}
+/**
+ * Sums up the memory used by the values it reads.
+ */
+class FFINSizeValueReader : public FFINValueReader {
+public:
+	int64 Size = 0;
+
+	virtual void nil() override { Size += sizeof(FFINAnyNetworkValue); }
+	virtual void operator<<(FINBool B) override { Size += sizeof(FFINAnyNetworkValue); }
+	virtual void operator<<(FINInt Num) override { Size += sizeof(FFINAnyNetworkValue); }
+	virtual void operator<<(FINFloat Num) override { Size += sizeof(FFINAnyNetworkValue); }
+	virtual void operator<<(FINClass Class) override { Size += sizeof(FFINAnyNetworkValue); }
+	virtual void operator<<(const FINStr& Str) override { Size += sizeof(FFINAnyNetworkValue) + Str.Len() * sizeof(TCHAR); }
+	virtual void operator<<(const FINObj& Obj) override { Size += sizeof(FFINAnyNetworkValue); }
+	virtual void operator<<(const FINTrace& Obj) override { Size += sizeof(FFINAnyNetworkValue); }
+	virtual void operator<<(const FINStruct& Struct) override { Size += sizeof(FFINAnyNetworkValue) + (Struct.GetStruct() ? Struct.GetStruct()->GetStructureSize() : 0); }
+};
+
+FFINNetworkMessageSignal::FFINNetworkMessageSignal(FGuid Sender, int Port, const TFINDynamicStruct<FFINParameterList>& Data, int64 Size, const TSharedPtr<FFINNetworkMessageTicket, ESPMode::ThreadSafe>& Ticket) : FFINSignal("NetworkMessage"), Sender(Sender), Port(Port), Data(Data), Size(Size), Ticket(Ticket) {}
 
 bool FFINNetworkMessageSignal::Serialize(FArchive& Ar) {
 	Super::Serialize(Ar);
@@ -116,9 +162,18 @@ bool FFINNetworkMessageSignal::Serialize(FArchive& Ar) {
 	Ar << Port;
 	Ar << Data;
 
+	// the size is not saved, and loaded messages don't occupy a slot of the card anymore
+	if (Ar.IsLoading()) Size = CalculateSize(Data);
+
 	return true;
 }
 
+int64 FFINNetworkMessageSignal::CalculateSize(const TFINDynamicStruct<FFINParameterList>& Data) {
+	FFINSizeValueReader Reader;
+	**Data >> Reader;
+	return Reader.Size;
+}
+
 int FFINNetworkMessageSignal::operator>>(FFINValueReader& reader) const {
 	reader << Sender.ToString();
 	reader << static_cast<FINInt>(Port);
@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include <atomic>
+
 #include "FINComputerModule.h"
 #include "Network/FINNetworkCircuitNode.h"
 #include "Network/FINNetworkComponent.h"
@@ -10,6 +12,33 @@
 #include "FINComputerNetworkCard.generated.h"
 
 class AFINComputerCase;
+
+/**
+ * Keeps track of the messages a network card has accepted but which are not yet processed by the receiving computer.
+ * Shared with the tickets of the messages, so they can still release themselves if the card got destroyed.
+ */
+struct FFINNetworkMessageQueueState {
+	std::atomic<int32> Count{0};
+};
+
+/**
+ * Occupies a slot in the message queue of a network card as long as it lives.
+ * Gets shared by all copies of a network message signal, so the slot gets released
+ * once the message got processed or dropped by all receivers.
+ */
+struct FFINNetworkMessageTicket {
+	TSharedRef<FFINNetworkMessageQueueState, ESPMode::ThreadSafe> Queue;
+
+	FFINNetworkMessageTicket(const TSharedRef<FFINNetworkMessageQueueState, ESPMode::ThreadSafe>& Queue) : Queue(Queue) {
+		Queue->Count.fetch_add(1, std::memory_order_relaxed);
+	}
+	FFINNetworkMessageTicket(const FFINNetworkMessageTicket&) = delete;
+	FFINNetworkMessageTicket& operator=(const FFINNetworkMessageTicket&) = delete;
+	~FFINNetworkMessageTicket() {
+		Queue->Count.fetch_sub(1, std::memory_order_relaxed);
+	}
+};
+
 UCLASS()
 class AFINComputerNetworkCard : public AFINComputerModule, public IFINNetworkCircuitNode, public IFINNetworkComponent, public IFINNetworkMessageInterface, public IFINNetworkCustomType {
 	GENERATED_BODY()
@@ -53,6 +82,25 @@ public:
 	*/
 	UPROPERTY()
 	UFINNetworkCircuit* Circuit = nullptr;
+
+	/**
+	 * The max amount of received messages which are not yet processed by the computer.
+	 * Further messages get refused till the computer processed some of them.
+	 */
+	UPROPERTY(EditDefaultsOnly)
+	int32 MaxQueuedMessages = 32;
+
+	/**
+	 * The max size in bytes the data of a single message is allowed to have.
+	 * The size of accepted messages gets charged to the memory of the receiving computer.
+	 */
+	UPROPERTY(EditDefaultsOnly)
+	int64 MaxMessageSize = 4096;
+
+	/**
+	 * The queue state of messages accepted by this network card.
+	 */
+	TSharedRef<FFINNetworkMessageQueueState, ESPMode::ThreadSafe> MessageQueue = MakeShared<FFINNetworkMessageQueueState, ESPMode::ThreadSafe>();
 	
 	// Begin AActor
 	virtual void BeginPlay() override;
@@ -62,7 +110,7 @@ public:
 	virtual TSet<UObject*> GetConnected_Implementation() const override;
 	virtual UFINNetworkCircuit* GetCircuit_Implementation() const override;
 	virtual void SetCircuit_Implementation(UFINNetworkCircuit* Circuit) override;
-	virtual void NotifyNetworkUpdate_Implementation(int Type, const TSet<UObject*>& Nodes) override;
+	virtual void NotifyNetworkUpdate_Implementation(int Type, const TSet<FGuid>& Components) override;
 	// End IFINNetworkCircuitNodes
 	
 	// Begin IFINNetworkComponent
@@ -76,7 +124,8 @@ public:
 
 	// Begin IFINNetworkMessageInterface
 	virtual bool IsPortOpen(int Port) override;
-	virtual void HandleMessage(FFINNetworkTrace Sender, int Port, const TFINDynamicStruct<FFINParameterList>& Data) override;
+	virtual TSet<int> GetOpenPorts() override;
+	virtual bool HandleMessage(FFINNetworkTrace Sender, int Port, const TFINDynamicStruct<FFINParameterList>& Data) override;
 	// End IFINNetworkMessageInterface
 
 	// Begin IFINNetworkCustomType
@@ -93,10 +142,10 @@ public:
 	void netFunc_closeAll();
 
 	UFUNCTION()
-	void netFunc_send(FString receiver, int port, FFINDynamicStructHolder args);
+	bool netFunc_send(FString receiver, int port, FFINDynamicStructHolder args);
 
 	UFUNCTION()
-	void netFunc_broadcast(int port, FFINDynamicStructHolder args);
+	int netFunc_broadcast(int port, FFINDynamicStructHolder args);
 };
 
 USTRUCT()
@@ -106,13 +155,24 @@ struct FFINNetworkMessageSignal : public FFINSignal {
 	FGuid Sender;
 	int Port;
 	TFINDynamicStruct<FFINParameterList> Data;
+	int64 Size = 0;
+	TSharedPtr<FFINNetworkMessageTicket, ESPMode::ThreadSafe> Ticket;
 
 	FFINNetworkMessageSignal() = default;
-	FFINNetworkMessageSignal(FGuid Sender, int Port, const TFINDynamicStruct<FFINParameterList>& Data);
+	FFINNetworkMessageSignal(FGuid Sender, int Port, const TFINDynamicStruct<FFINParameterList>& Data, int64 Size, const TSharedPtr<FFINNetworkMessageTicket, ESPMode::ThreadSafe>& Ticket = nullptr);
 
 	bool Serialize(FArchive& Ar);
 	
 	virtual int operator>>(FFINValueReader& reader) const override;
+	virtual int64 GetPayloadSize() const override { return Size; }
+
+	/**
+	 * Calculates the amount of memory in bytes the given message data uses.
+	 *
+	 * @param[in]	Data	the message data you want to get the size of
+	 * @return	the size of the message data in bytes
+	 */
+	static int64 CalculateSize(const TFINDynamicStruct<FFINParameterList>& Data);
 };
 
 template<>
@@ -21,11 +21,27 @@ void AFINComputerSubsystem::BeginPlay() {
 	Version = EFINCustomVersion::FINLatestVersion;
 }
 
+void AFINComputerSubsystem::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	KernelScheduler.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AFINComputerSubsystem::Tick(float dt) {
 	Super::Tick(dt);
+	if (KernelScheduler) KernelScheduler->Tick(dt, KernelTickBudget, LuaInstructionBudget);
 	this->GetWorld()->GetFirstPlayerController()->PushInputComponent(Input);
 }
 
+void AFINComputerSubsystem::AddComputer(AFINComputerCase* Computer) {
+	if (!KernelScheduler) KernelScheduler = MakeUnique<FFINKernelScheduler>(KernelWorkerCount);
+	KernelScheduler->AddComputer(Computer);
+}
+
+void AFINComputerSubsystem::RemoveComputer(AFINComputerCase* Computer) {
+	if (KernelScheduler) KernelScheduler->RemoveComputer(Computer);
+}
+
 bool AFINComputerSubsystem::ShouldSave_Implementation() const {
 	return true;
 }
@@ -75,7 +91,8 @@ void AFINComputerSubsystem::OnSecondaryFireReleased() {
 }
 
 AFINComputerSubsystem* AFINComputerSubsystem::GetComputerSubsystem(UObject* WorldContext) {
-	return GetSubsystemHolder<UFINSubsystemHolder>(WorldContext)->ComputerSubsystem;
+	UFINSubsystemHolder* Holder = GetSubsystemHolder<UFINSubsystemHolder>(WorldContext);
+	return Holder ? Holder->ComputerSubsystem : nullptr;
 }
 
 UWidgetInteractionComponent* AFINComputerSubsystem::AttachWidgetInteractionToPlayer(AFGCharacterPlayer* character) {
@@ -4,6 +4,7 @@
 #include "FGSaveInterface.h"
 #include "FGSubsystem.h"
 #include "FicsItNetworksCustomVersion.h"
+#include "FINKernelScheduler.h"
 #include "Queue.h"
 #include "WidgetInteractionComponent.h"
 #include "Engine/Engine.h"
@@ -25,10 +26,33 @@ public:
 	UPROPERTY(SaveGame)
 	TEnumAsByte<EFINCustomVersion> Version = EFINCustomVersion::FINBeforeCustomVersionWasAdded;
 
+	/**
+	 * The count of worker threads ticking the kernels of the computers, 0 picks it based on the core count.
+	 */
+	UPROPERTY(EditDefaultsOnly)
+	int32 KernelWorkerCount = 0;
+
+	/**
+	 * The max amount of seconds per frame kernel ticks get started in, 0 for unlimited.
+	 * Kernels which didn't get ticked within the budget get ticked first in the next frame.
+	 */
+	UPROPERTY(EditDefaultsOnly)
+	float KernelTickBudget = 0.008f;
+
+	/**
+	 * The max amount of Lua instructions all computers together are allowed to execute per frame, 0 for unlimited.
+	 * If the computers would exceed it, they get throttled in proportion to the speed of their processors.
+	 */
+	UPROPERTY(EditDefaultsOnly)
+	int64 LuaInstructionBudget = 0;
+
+	TUniquePtr<FFINKernelScheduler> KernelScheduler;
+
 	AFINComputerSubsystem();
 
 	// Begin AActor
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float dt) override;
 	// End AActor
 	
@@ -36,6 +60,16 @@ public:
 	virtual bool ShouldSave_Implementation() const override;
 	// End IFGSaveInterface
 
+	/**
+	 * Adds the given computer to the computers whose kernels get ticked by the kernel scheduler.
+	 */
+	void AddComputer(AFINComputerCase* Computer);
+
+	/**
+	 * Removes the given computer from the computers whose kernels get ticked by the kernel scheduler.
+	 */
+	void RemoveComputer(AFINComputerCase* Computer);
+
 	void OnPrimaryFirePressed();
 	void OnPrimaryFireReleased();
 	void OnSecondaryFirePressed();
@@ -0,0 +1,147 @@
+﻿#include "FINKernelScheduler.h"
+
+#include "FINComputerCase.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+
+FFINKernelScheduler::FWorker::FWorker(FFINKernelScheduler& Scheduler, int32 Index) : Scheduler(Scheduler), Index(Index) {
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("FINKernelWorker%d"), Index), 0, TPri_Normal);
+}
+
+FFINKernelScheduler::FWorker::~FWorker() {
+	if (Thread) {
+		Thread->Kill(true);
+		delete Thread;
+	}
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+}
+
+uint32 FFINKernelScheduler::FWorker::Run() {
+	while (true) {
+		WorkEvent->Wait();
+		if (bStop.load()) break;
+		Scheduler.RunJobs(Index);
+		if (Scheduler.FrameWorkersRunning.fetch_sub(1) == 1) Scheduler.FrameDoneEvent->Trigger();
+	}
+	return 0;
+}
+
+void FFINKernelScheduler::FWorker::Stop() {
+	bStop.store(true);
+	WorkEvent->Trigger();
+}
+
+FFINKernelScheduler::FFINKernelScheduler(int32 WorkerCount) {
+	if (WorkerCount <= 0) WorkerCount = FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads() / 2 - 1, 1, 8);
+	FrameDoneEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Queues.Add(MakeUnique<FQueue>());
+	for (int32 i = 1; i <= WorkerCount; ++i) {
+		Queues.Add(MakeUnique<FQueue>());
+		Workers.Add(MakeUnique<FWorker>(*this, i));
+	}
+}
+
+FFINKernelScheduler::~FFINKernelScheduler() {
+	Workers.Empty();
+	// the kernels outlive the scheduler if it gets destroyed before the computers
+	for (AFINComputerCase* Computer : Computers) {
+		if (Computer->kernel) Computer->kernel->setInstructionBudget(nullptr);
+	}
+	FPlatformProcess::ReturnSynchEventToPool(FrameDoneEvent);
+}
+
+void FFINKernelScheduler::AddComputer(AFINComputerCase* Computer) {
+	check(IsInGameThread());
+	Computers.AddUnique(Computer);
+	if (Computer->kernel) Computer->kernel->setInstructionBudget(&Instructions);
+}
+
+void FFINKernelScheduler::RemoveComputer(AFINComputerCase* Computer) {
+	check(IsInGameThread());
+	Computers.Remove(Computer);
+	if (Computer->kernel) Computer->kernel->setInstructionBudget(nullptr);
+}
+
+bool FFINKernelScheduler::TakeJob(int32 QueueIndex, int32& OutJob) {
+	{
+		FQueue& Queue = *Queues[QueueIndex];
+		FScopeLock Lock(&Queue.Lock);
+		if (Queue.Jobs.Num() > 0) {
+			OutJob = Queue.Jobs.Pop(false);
+			return true;
+		}
+	}
+	for (int32 i = 1; i < Queues.Num(); ++i) {
+		FQueue& Victim = *Queues[(QueueIndex + i) % Queues.Num()];
+		FScopeLock Lock(&Victim.Lock);
+		if (Victim.Jobs.Num() > 0) {
+			OutJob = Victim.Jobs[0];
+			Victim.Jobs.RemoveAt(0, 1, false);
+			return true;
+		}
+	}
+	return false;
+}
+
+void FFINKernelScheduler::RunJobs(int32 QueueIndex) {
+	int32 Job;
+	while (TakeJob(QueueIndex, Job)) {
+		if (FrameDeadline <= 0.0 || FPlatformTime::Seconds() < FrameDeadline) {
+			FrameJobs[Job]->TickKernel(FrameDeltaTime);
+			FrameJobsTicked[Job] = true;
+		}
+	}
+}
+
+void FFINKernelScheduler::Tick(float DeltaTime, double Budget, int64 InstructionBudget) {
+	check(IsInGameThread());
+	if (Computers.Num() < 1) return;
+
+	Instructions.beginFrame(InstructionBudget);
+
+	for (AFINComputerCase* Computer : Computers) {
+		Computer->KernelTickTime = FMath::Min(Computer->KernelTickTime + DeltaTime, 10.0f);
+	}
+
+	FrameJobs = Computers;
+	FrameJobsTicked.Init(false, FrameJobs.Num());
+	FrameDeltaTime = DeltaTime;
+	FrameDeadline = Budget > 0.0 ? FPlatformTime::Seconds() + Budget : 0.0;
+	for (int32 i = 0; i < Queues.Num(); ++i) {
+		FQueue& Queue = *Queues[i];
+		FScopeLock Lock(&Queue.Lock);
+		for (int32 Job = i; Job < FrameJobs.Num(); Job += Queues.Num()) {
+			Queue.Jobs.Add(Job);
+		}
+	}
+
+	// the workers only touch the frame data between getting woken up and parking again,
+	// the atomic store publishes the frame data to them
+	FrameWorkersRunning.store(Workers.Num());
+	for (const TUniquePtr<FWorker>& Worker : Workers) Worker->WorkEvent->Trigger();
+	RunJobs(0);
+	if (Workers.Num() > 0) FrameDoneEvent->Wait();
+
+	// skipped computers go to the front, so they get ticked first in the next frame,
+	// the ticked ones rotate so every computer gets early access to the donated instructions once in a while
+	TArray<AFINComputerCase*> Skipped;
+	TArray<AFINComputerCase*> Ticked;
+	for (int32 i = 0; i < FrameJobs.Num(); ++i) {
+		(FrameJobsTicked[i] ? Ticked : Skipped).Add(FrameJobs[i]);
+	}
+	if (Ticked.Num() > 1) {
+		AFINComputerCase* First = Ticked[0];
+		Ticked.RemoveAt(0);
+		Ticked.Add(First);
+	}
+	Computers = MoveTemp(Skipped);
+	Computers.Append(Ticked);
+
+	// resolve all futures of this frame in one go, no kernel is running anymore
+	for (AFINComputerCase* Computer : FrameJobs) {
+		if (Computer->kernel) Computer->kernel->handleFutures();
+	}
+	FrameJobs.Empty();
+}
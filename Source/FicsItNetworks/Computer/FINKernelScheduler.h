@@ -0,0 +1,120 @@
+﻿#pragma once
+
+#include <atomic>
+
+#include "CoreMinimal.h"
+#include "FicsItKernel/Processor/InstructionBudget.h"
+#include "HAL/Runnable.h"
+
+class AFINComputerCase;
+class FRunnableThread;
+class FEvent;
+
+/**
+ * Ticks the kernels of all registered computers once per frame on a fixed pool of worker threads.
+ * The kernel ticks of a frame get distributed over the queues of the workers,
+ * workers running out of work steal kernel ticks from the queues of the other workers.
+ * The game thread helps working off the queues and waits till all workers are parked again,
+ * so the frame data can't be accessed by a worker while the next frame gets set up.
+ * As soon as the CPU time budget of the frame is exhausted, the remaining kernels are skipped for this frame,
+ * keep their accumulated tick time and get ticked first in the next frame.
+ * All kernels share one instruction budget per frame, which caps the total amount of processor instructions
+ * and throttles the kernels fairly if it is exceeded.
+ * Computers can only be added, removed and ticked from the game thread.
+ */
+class FFINKernelScheduler {
+private:
+	class FWorker : public FRunnable {
+	public:
+		FFINKernelScheduler& Scheduler;
+		int32 Index;
+		FEvent* WorkEvent = nullptr;
+		FRunnableThread* Thread = nullptr;
+		std::atomic<bool> bStop{false};
+
+		FWorker(FFINKernelScheduler& Scheduler, int32 Index);
+		virtual ~FWorker() override;
+
+		// Begin FRunnable
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+		// End FRunnable
+	};
+
+	/**
+	 * Queue of kernel ticks of a worker.
+	 * The owner pops from the back, other workers steal from the front.
+	 */
+	struct FQueue {
+		FCriticalSection Lock;
+		TArray<int32> Jobs;
+	};
+
+	TArray<AFINComputerCase*> Computers;
+	TArray<TUniquePtr<FWorker>> Workers;
+	FicsItKernel::InstructionBudget Instructions;
+
+	/**
+	 * The queues of the current frame. The first queue belongs to the game thread, the others to the workers.
+	 */
+	TArray<TUniquePtr<FQueue>> Queues;
+
+	/**
+	 * The data of the current frame, only written by the game thread while all workers are parked.
+	 */
+	TArray<AFINComputerCase*> FrameJobs;
+	TArray<uint8> FrameJobsTicked;
+	float FrameDeltaTime = 0.0f;
+	double FrameDeadline = 0.0;
+
+	/**
+	 * The count of workers which got woken up for the current frame and didn't park yet.
+	 */
+	std::atomic<int32> FrameWorkersRunning{0};
+	FEvent* FrameDoneEvent = nullptr;
+
+	/**
+	 * Takes the next kernel tick from the queue with the given index or steals one from the other queues.
+	 *
+	 * @param[in]	QueueIndex	the index of the queue of the calling thread
+	 * @param[out]	OutJob		the index of the job in the frame jobs
+	 * @return	false if there is no kernel tick left
+	 */
+	bool TakeJob(int32 QueueIndex, int32& OutJob);
+
+	/**
+	 * Works off kernel ticks of the current frame till no kernel tick is left.
+	 *
+	 * @param[in]	QueueIndex	the index of the queue of the calling thread
+	 */
+	void RunJobs(int32 QueueIndex);
+
+public:
+	/**
+	 * @param[in]	WorkerCount		the count of worker threads, 0 picks it based on the core count
+	 */
+	FFINKernelScheduler(int32 WorkerCount = 0);
+	FFINKernelScheduler(const FFINKernelScheduler&) = delete;
+	FFINKernelScheduler& operator=(const FFINKernelScheduler&) = delete;
+	~FFINKernelScheduler();
+
+	/**
+	 * Adds the given computer to the computers getting ticked.
+	 */
+	void AddComputer(AFINComputerCase* Computer);
+
+	/**
+	 * Removes the given computer from the computers getting ticked.
+	 */
+	void RemoveComputer(AFINComputerCase* Computer);
+
+	/**
+	 * Ticks the kernels of all computers and blocks till they are done or skipped,
+	 * afterwards resolves the futures pushed by the kernels.
+	 *
+	 * @param[in]	DeltaTime			the time in seconds since the last frame
+	 * @param[in]	Budget				the max amount of seconds kernel ticks are started in, 0 for unlimited
+	 * @param[in]	InstructionBudget	the max amount of processor instructions all kernels together execute, 0 for unlimited
+	 */
+	void Tick(float DeltaTime, double Budget, int64 InstructionBudget = 0);
+};
@@ -89,6 +89,8 @@ namespace FicsItKernel {
 	}
 
 	void KernelSystem::pushFuture(TSharedPtr<TFINDynamicStruct<FFINFuture>> future) {
+		// make the future struct private to the holder now, so executing it in the main thread doesn't have to swap it
+		future->GetMutableData();
 		futureQueue.push(future);
 	}
 
@@ -96,7 +98,7 @@ namespace FicsItKernel {
 		while (futureQueue.size() > 0) {
 			TSharedPtr<TFINDynamicStruct<FFINFuture>> future = futureQueue.front();
 			futureQueue.pop();
-			(*future)->Execute();
+			future->GetMutable<FFINFuture>().Execute();
 		}
 	}
 
@@ -191,6 +193,7 @@ namespace FicsItKernel {
 		memoryUsage = processor->getMemoryUsage(components & PROCESSOR);
 		memoryUsage += filesystem.getMemoryUsage(components & FILESYSTEM);
 		memoryUsage += devDevice->getSerial()->getSize();
+		if (network) memoryUsage += network->getMemoryUsage();
 
 		if (memoryUsage > memoryCapacity) crash({"out of memory"});
 		FileSystem::SRef<FicsItFS::DevDevice> dev = filesystem.getDevDevice();
@@ -209,6 +212,14 @@ namespace FicsItKernel {
 		audio.reset(controller);
 	}
 
+	InstructionBudget* KernelSystem::getInstructionBudget() const {
+		return instructionBudget;
+	}
+
+	void KernelSystem::setInstructionBudget(InstructionBudget* budget) {
+		instructionBudget = budget;
+	}
+
 	Network::NetworkController* KernelSystem::getNetwork() {
 		return network.get();
 	}
@@ -261,7 +272,7 @@ namespace FicsItKernel {
 		}
 	}
 	
-	void KernelSystem::Serialize(FArchive& Ar, FKernelSystemSerializationInfo& OutSystemState) {
+	void KernelSystem::Serialize(FArchive& Ar, FKernelSystemSerializationInfo& OutSystemState, int32 Version) {
 		if (!Ar.IsSaveGame() || !OutSystemState.bPreSerialized) return;
 		
 		// serialize system state
@@ -296,7 +307,7 @@ namespace FicsItKernel {
 		}
 		
 		// Serialize Network
-		network->Serialize(Ar);
+		network->Serialize(Ar, Version);
 
 		OutSystemState.devDeviceMountPoint = UTF8_TO_TCHAR(filesystem.getMountPoint(devDevice).str().c_str());
 		Ar << OutSystemState.devDeviceMountPoint;
@@ -4,6 +4,7 @@
 #include <queue>
 
 
+#include "Processor/InstructionBudget.h"
 #include "Processor/Processor.h"
 #include "FicsItFS/FINFileSystemState.h"
 #include "FicsItFS/DevDevice.h"
@@ -59,6 +60,7 @@ namespace FicsItKernel {
 		std::unordered_map<AFINFileSystemState*, FileSystem::SRef<FileSystem::Device>> drives;
 		std::unique_ptr<Network::NetworkController> network = nullptr;
 		std::unique_ptr<Audio::AudioController> audio = nullptr;
+		InstructionBudget* instructionBudget = nullptr;
 		FileSystem::SRef<KernelListener> listener;
 		TSharedPtr<FJsonObject> readyToUnpersist = nullptr;
 		TSet<FWeakObjectPtr> gpus;
@@ -242,6 +244,20 @@ namespace FicsItKernel {
 		 */
 		void setAudio(Audio::AudioController* controller);
 
+		/**
+		 * Returns the instruction budget the processor has to take the instructions of its ticks from.
+		 * Nullptr if the processor is not limited by a budget.
+		 */
+		InstructionBudget* getInstructionBudget() const;
+
+		/**
+		 * Sets the instruction budget the processor has to take the instructions of its ticks from.
+		 * The budget is not managed by the kernel and has to outlive it or get unset.
+		 *
+		 * @param[in]	budget	the instruction budget, nullptr if the processor should not be limited
+		 */
+		void setInstructionBudget(InstructionBudget* budget);
+
 		/**
 		 * Get current used memory.
 		 *
@@ -315,8 +331,9 @@ namespace FicsItKernel {
 		 *
 		 * @param[in]	Ar				The Archive were to/from un/serialize from/to.
 		 * @parm[out]	OutSystemState	the structure which will hold the system state
+		 * @param[in]	Version			the FIN version of the save the archive belongs to
 		 */
-		void Serialize(FArchive& Ar, FKernelSystemSerializationInfo& OutSystemState);
+		void Serialize(FArchive& Ar, FKernelSystemSerializationInfo& OutSystemState, int32 Version);
 
 		/**
 		 * This will cause the processor finally to load it's state.
@@ -5,39 +5,77 @@
 
 #include "Network/FINDynamicStructHolder.h"
 #include "Network/FINNetworkCircuitNode.h"
+#include "FicsItNetworksCustomVersion.h"
 
 namespace FicsItKernel {
 	namespace Network {
-		void NetworkController::handleSignal(const TFINDynamicStruct<FFINSignal>& signal, const FFINNetworkTrace& sender) {
-			pushSignal(signal, sender);
+		bool NetworkController::handleSignal(const TFINDynamicStruct<FFINSignal>& signal, const FFINNetworkTrace& sender) {
+			return pushSignal(signal, sender);
 		}
 
 		TFINDynamicStruct<FFINSignal> NetworkController::popSignal(FFINNetworkTrace& sender) {
-			if (getSignalCount() < 1) return TFINDynamicStruct<FFINSignal>(nullptr, nullptr);
-			mutexSignals.lock();
-			auto sig = signals.front();
-			signals.pop_front();
-			mutexSignals.unlock();
-			sender = sig.Value;
-			return sig.Key;
+			FFINDynamicStructHolder signal;
+			if (!signals.pop(signal, sender)) return TFINDynamicStruct<FFINSignal>(nullptr, nullptr);
+			return signal;
 		}
 
-		void NetworkController::pushSignal(const TFINDynamicStruct<FFINSignal>& signal, const FFINNetworkTrace& sender) {
-			std::lock_guard<std::mutex> m(mutexSignals);
-			if (signals.size() >= maxSignalCount || lockSignalRecieving) return;
-			signals.push_back(TPair<TFINDynamicStruct<FFINSignal>, FFINNetworkTrace>{signal, sender});
+		bool NetworkController::pushSignal(const TFINDynamicStruct<FFINSignal>& signal, const FFINNetworkTrace& sender) {
+			if (lockSignalRecieving) return false;
+			{
+				FReadScopeLock Lock(signalFiltersLock);
+				if (signalFilters.Num() > 0) {
+					const SignalFilter* filter = signalFilters.Find(sender.GetUnderlyingPtr());
+					if (filter && signal.GetData() && !filter->matches(*signal)) return false;
+				}
+			}
+			FReadScopeLock Lock(signalsLock);
+			return signals.push(signal, sender);
+		}
+
+		void NetworkController::setSignalFilter(UObject* sender, const SignalFilter& filter) {
+			FWriteScopeLock Lock(signalFiltersLock);
+			if (filter.isEmpty()) {
+				signalFilters.Remove(sender);
+			} else {
+				signalFilters.Add(sender, filter);
+			}
+		}
+
+		void NetworkController::removeSignalFilter(UObject* sender) {
+			FWriteScopeLock Lock(signalFiltersLock);
+			signalFilters.Remove(sender);
+		}
+
+		void NetworkController::clearSignalFilters() {
+			FWriteScopeLock Lock(signalFiltersLock);
+			signalFilters.Empty();
 		}
 
 		void NetworkController::clearSignals() {
-			std::lock_guard<std::mutex> m(mutexSignals);
 			signals.clear();
 		}
 
 		size_t NetworkController::getSignalCount() {
-			std::lock_guard<std::mutex> m(mutexSignals);
 			return signals.size();
 		}
 
+		void NetworkController::setMaxSignalCount(uint32 count) {
+			FWriteScopeLock Lock(signalsLock);
+			signals.resize(FMath::Clamp(count, 1u, static_cast<uint32>(signalCountLimit)));
+		}
+
+		uint32 NetworkController::getMaxSignalCount() const {
+			return signals.getCapacity();
+		}
+
+		uint64 NetworkController::getDroppedSignalCount() const {
+			return signals.getDropped();
+		}
+
+		std::int64_t NetworkController::getMemoryUsage() const {
+			return signals.getMemoryUsage();
+		}
+
 		FFINNetworkTrace NetworkController::getComponentByID(const FString& id) {
 			FGuid guid;
 			if (FGuid::Parse(id, guid)) {
@@ -64,7 +102,7 @@ namespace FicsItKernel {
 			lockSignalRecieving = true;
 		}
 
-		void NetworkController::Serialize(FArchive& Ar) {
+		void NetworkController::Serialize(FArchive& Ar, int32 Version) {
 			// serialize signal listeners
 			TArray<FFINNetworkTrace> networkTraces;
 			if (Ar.IsSaving()) for (const FFINNetworkTrace& trace : signalListeners) {
@@ -76,16 +114,23 @@ namespace FicsItKernel {
 			}
 
 			// serialize signals
-			int32 signalCount = signals.size();
-			Ar << signalCount;
-			if (Ar.IsLoading()) {
+			TArray<TPair<FFINDynamicStructHolder, FFINNetworkTrace>> Signals;
+			if (Ar.IsSaving()) {
+				// take the signals out of the queue and put them back afterwards, signal recieving is locked while serializing
+				signals.popBatch(Signals, MAX_int32);
+				for (const TPair<FFINDynamicStructHolder, FFINNetworkTrace>& Signal : Signals) {
+					signals.push(Signal.Key, Signal.Value);
+				}
+			} else {
 				signals.clear();
 			}
+			int32 signalCount = Signals.Num();
+			Ar << signalCount;
 			for (int i = 0; i < signalCount; ++i) {
 				TFINDynamicStruct<FFINSignal> Signal;
 				FFINNetworkTrace Trace;
 				if (Ar.IsSaving()) {
-					const auto& sig = signals[i];
+					const auto& sig = Signals[i];
 					Signal = sig.Key;
 					Trace = sig.Value;
 				}
@@ -98,12 +143,35 @@ namespace FicsItKernel {
 				Trace.Serialize(Ar);
 				
 				if (Ar.IsLoading()) {
-					signals.push_back(TPair<TFINDynamicStruct<FFINSignal>, FFINNetworkTrace>{Signal, Trace});
+					signals.push(Signal, Trace);
 				}
 			}
 
 			// serialize signal senders
 			Ar << signalSenders;
+
+			// serialize signal filters
+			if (Version >= EFINCustomVersion::FINSignalFilters) {
+				FWriteScopeLock Lock(signalFiltersLock);
+				int32 filterCount = signalFilters.Num();
+				Ar << filterCount;
+				if (Ar.IsSaving()) {
+					for (TPair<TWeakObjectPtr<UObject>, SignalFilter>& Filter : signalFilters) {
+						UObject* Sender = Filter.Key.Get();
+						Ar << Sender;
+						Ar << Filter.Value;
+					}
+				} else {
+					signalFilters.Empty();
+					for (int32 i = 0; i < filterCount; ++i) {
+						UObject* Sender = nullptr;
+						SignalFilter Filter;
+						Ar << Sender;
+						Ar << Filter;
+						if (Sender) signalFilters.Add(Sender, Filter);
+					}
+				}
+			}
 		}
 
 		void NetworkController::PostSerialize(bool load) {
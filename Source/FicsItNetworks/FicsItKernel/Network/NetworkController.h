@@ -2,9 +2,11 @@
 
 #include "CoreMinimal.h"
 
-#include <deque>
 #include <mutex>
 
+#include "Misc/ScopeRWLock.h"
+#include "SignalFilter.h"
+#include "SignalQueue.h"
 #include "Network/FINNetworkTrace.h"
 #include "Network/Signals/FINSignal.h"
 #include "Network/Signals/FINSmartSignal.h"
@@ -19,11 +21,19 @@ namespace FicsItKernel {
 		protected:
 			std::mutex mutexSignalListeners;
 			TSet<FFINNetworkTrace> signalListeners;
-			std::mutex mutexSignals;
-			std::deque<TPair<TFINDynamicStruct<FFINSignal>, FFINNetworkTrace>> signals;
+			SignalQueue signals{32};
+			mutable FRWLock signalsLock; // pushes share it, resizing the queue takes it exclusively
 			bool lockSignalRecieving = false;
 
+			mutable FRWLock signalFiltersLock;
+			TMap<TWeakObjectPtr<UObject>, SignalFilter> signalFilters;
+
 		public:
+			/**
+			 * The maximum amount of signals the queue can be set to hold.
+			 */
+			static const uint32 signalCountLimit = 1 << 16;
+
 			virtual ~NetworkController() {}
 
 			/**
@@ -38,12 +48,7 @@ namespace FicsItKernel {
 			 */
 			UObject* component = nullptr;
 
-			/**
-			 * The maximum amount of signals the signal queue can hold
-			 */
-			uint32 maxSignalCount = 32;
-
-			void handleSignal(const TFINDynamicStruct<FFINSignal>& signal, const FFINNetworkTrace& sender);
+			bool handleSignal(const TFINDynamicStruct<FFINSignal>& signal, const FFINNetworkTrace& sender);
 
 			/**
 			 * pops a signal form the queue.
@@ -57,10 +62,36 @@ namespace FicsItKernel {
 			/**
 			 * pushes a signal to the queue.
 			 * signal gets dropped if the queue is already full.
+			 * Thread safe.
 			 *
 			 * @param	signal	the singal you want to push
+			 * @return	false if the signal got dropped by the filter of the sender or because the queue is full
+			 */
+			bool pushSignal(const TFINDynamicStruct<FFINSignal>& signal, const FFINNetworkTrace& sender);
+
+			/**
+			 * Sets the filter signals of the given sender have to pass to get queued.
+			 * An empty filter removes the filter of the sender.
+			 * Thread safe.
+			 *
+			 * @param[in]	sender	the object sending the signals you want to filter
+			 * @param[in]	filter	the filter the signals have to pass
+			 */
+			void setSignalFilter(UObject* sender, const SignalFilter& filter);
+
+			/**
+			 * Removes the filter of the given sender, so all of its signals get queued again.
+			 * Thread safe.
+			 *
+			 * @param[in]	sender	the object sending the signals
 			 */
-			void pushSignal(const TFINDynamicStruct<FFINSignal>& signal, const FFINNetworkTrace& sender);
+			void removeSignalFilter(UObject* sender);
+
+			/**
+			 * Removes the filters of all senders.
+			 * Thread safe.
+			 */
+			void clearSignalFilters();
 
 			/**
 			 * Removes all signals from the signal queue.
@@ -74,6 +105,31 @@ namespace FicsItKernel {
 			 */
 			size_t getSignalCount();
 
+			/**
+			 * Sets the maximum amount of signals the queue can hold.
+			 * Gets clamped to signalCountLimit and rounded up to the next power of two.
+			 * Signals already in the queue are kept as long as they fit.
+			 * Thread safe, but only allowed to get called by the kernel popping the signals.
+			 *
+			 * @param[in]	count	the new max amount of signals
+			 */
+			void setMaxSignalCount(uint32 count);
+
+			/**
+			 * returns the maximum amount of signals the queue can hold.
+			 */
+			uint32 getMaxSignalCount() const;
+
+			/**
+			 * returns the amount of signals dropped because the queue was full.
+			 */
+			uint64 getDroppedSignalCount() const;
+
+			/**
+			 * returns the amount of kernel memory used by the signal queue.
+			 */
+			std::int64_t getMemoryUsage() const;
+
 			/**
 			 * trys to find a component with the given ID.
 			 *
@@ -106,9 +162,10 @@ namespace FicsItKernel {
 			/**
 			 * De/Serializes the Network Controller to a archive
 			 *
-			 * @param[in]	Ar	the archive storing the infromation
+			 * @param[in]	Ar		the archive storing the infromation
+			 * @param[in]	Version	the FIN version of the save the archive belongs to
 			 */
-			void Serialize(FArchive& Ar);
+			void Serialize(FArchive& Ar, int32 Version);
 
 			/**
 			* Should get called after de/serialization
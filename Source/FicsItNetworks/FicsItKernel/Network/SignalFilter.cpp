@@ -0,0 +1,77 @@
+#include "SignalFilter.h"
+
+namespace FicsItKernel {
+	namespace Network {
+		/**
+		 * Collects the parameters of a signal up to the highest index a filter is interested in.
+		 */
+		class SignalFilterArgReader : public FFINValueReader {
+		public:
+			TArray<FFINAnyNetworkValue> Values;
+			
+			virtual void nil() override { Values.Add(FFINAnyNetworkValue()); }
+			virtual void operator<<(FINBool B) override { Values.Add(FFINAnyNetworkValue(B)); }
+			virtual void operator<<(FINInt Num) override { Values.Add(FFINAnyNetworkValue(Num)); }
+			virtual void operator<<(FINFloat Num) override { Values.Add(FFINAnyNetworkValue(Num)); }
+			virtual void operator<<(FINClass Class) override { Values.Add(FFINAnyNetworkValue(Class)); }
+			virtual void operator<<(const FINStr& Str) override { Values.Add(FFINAnyNetworkValue(Str)); }
+			virtual void operator<<(const FINObj& Obj) override { Values.Add(FFINAnyNetworkValue(Obj)); }
+			virtual void operator<<(const FINTrace& Obj) override { Values.Add(FFINAnyNetworkValue(Obj)); }
+			virtual void operator<<(const FINStruct& Struct) override { Values.Add(FFINAnyNetworkValue(Struct)); }
+		};
+
+		static bool signalFilterArgMatches(const FFINAnyNetworkValue& Value, const FFINAnyNetworkValue& Expected) {
+			const EFINNetworkValueType Type = Value.GetType();
+			const EFINNetworkValueType ExpectedType = Expected.GetType();
+			if ((Type == FIN_INT || Type == FIN_FLOAT) && (ExpectedType == FIN_INT || ExpectedType == FIN_FLOAT)) {
+				const FINFloat A = Type == FIN_INT ? static_cast<FINFloat>(Value.GetInt()) : Value.GetFloat();
+				const FINFloat B = ExpectedType == FIN_INT ? static_cast<FINFloat>(Expected.GetInt()) : Expected.GetFloat();
+				return A == B;
+			}
+			return Value == Expected;
+		}
+
+		bool SignalFilter::matches(const FFINSignal& signal) const {
+			if (Names.Num() > 0 && !Names.Contains(signal.GetNameId())) return false;
+			if (Args.Num() < 1) return true;
+			
+			SignalFilterArgReader reader;
+			signal >> reader;
+			for (const TPair<int32, FFINAnyNetworkValue>& Arg : Args) {
+				if (!reader.Values.IsValidIndex(Arg.Key)) {
+					// missing parameters are nil
+					if (Arg.Value.GetType() != FIN_NIL) return false;
+					continue;
+				}
+				if (!signalFilterArgMatches(reader.Values[Arg.Key], Arg.Value)) return false;
+			}
+			return true;
+		}
+
+		bool SignalFilter::isEmpty() const {
+			return Names.Num() < 1 && Args.Num() < 1;
+		}
+
+		void SignalFilter::Serialize(FArchive& Ar) {
+			Ar << Names;
+			
+			int32 ArgCount = Args.Num();
+			Ar << ArgCount;
+			if (Ar.IsSaving()) {
+				for (TPair<int32, FFINAnyNetworkValue>& Arg : Args) {
+					Ar << Arg.Key;
+					Arg.Value.Serialize(Ar);
+				}
+			} else {
+				Args.Empty();
+				for (int32 i = 0; i < ArgCount; ++i) {
+					int32 Index;
+					FFINAnyNetworkValue Value;
+					Ar << Index;
+					Value.Serialize(Ar);
+					Args.Add(Index, Value);
+				}
+			}
+		}
+	}
+}
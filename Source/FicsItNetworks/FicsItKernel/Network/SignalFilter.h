@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Network/FINAnyNetworkValue.h"
+#include "Network/Signals/FINSignal.h"
+
+namespace FicsItKernel {
+	namespace Network {
+		/**
+		 * Filter deciding if a signal of a sender should get queued by the network controller.
+		 * A signal matches if its name is one of the allowed names (or no names are given)
+		 * and all argument predicates hold for the signals parameters.
+		 * Argument predicates compare the parameter at the given index with a value,
+		 * numbers get compared by their value regardless of being integer or float.
+		 */
+		class SignalFilter {
+		public:
+			/**
+			 * The names of the signals allowed to pass, all signals pass if empty.
+			 * Contains the empty name, which no signal has, if a name unknown at the time the filter got created was given.
+			 */
+			TSet<FFINName> Names;
+
+			/**
+			 * Values the parameters at the given (zero based) index need to equal.
+			 */
+			TMap<int32, FFINAnyNetworkValue> Args;
+
+			/**
+			 * Checks if the given signal passes the filter.
+			 *
+			 * @param[in]	signal	the signal you want to check
+			 * @return	true if the signal should get queued
+			 */
+			bool matches(const FFINSignal& signal) const;
+
+			/**
+			 * Checks if the filter lets all signals pass.
+			 */
+			bool isEmpty() const;
+
+			void Serialize(FArchive& Ar);
+		};
+
+		inline FArchive& operator<<(FArchive& Ar, SignalFilter& Filter) {
+			Filter.Serialize(Ar);
+			return Ar;
+		}
+	}
+}
@@ -0,0 +1,121 @@
+#include "SignalQueue.h"
+
+namespace FicsItKernel {
+	namespace Network {
+		static std::int64_t signalPayloadSize(const FFINDynamicStructHolder& signal) {
+			const FFINSignal* Signal = static_cast<const FFINSignal*>(signal.GetData());
+			return Signal ? Signal->GetPayloadSize() : 0;
+		}
+
+		SignalQueue::SignalQueue(std::uint32_t capacity) {
+			allocate(capacity);
+		}
+
+		SignalQueue::~SignalQueue() {
+			release();
+		}
+
+		void SignalQueue::allocate(std::uint32_t newCapacity) {
+			capacity = FMath::RoundUpToPowerOfTwo(FMath::Max(newCapacity, 1u));
+			mask = capacity - 1;
+			slots = new Slot[capacity];
+			for (std::uint32_t i = 0; i < capacity; ++i) {
+				slots[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+			enqueuePos.store(0, std::memory_order_relaxed);
+			dequeuePos = 0;
+			count.store(0, std::memory_order_release);
+			payloadSize.store(0, std::memory_order_relaxed);
+		}
+
+		void SignalQueue::release() {
+			delete[] slots;
+			slots = nullptr;
+		}
+
+		bool SignalQueue::push(const FFINDynamicStructHolder& signal, const FFINNetworkTrace& sender) {
+			std::uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+			Slot* slot;
+			while (true) {
+				slot = &slots[pos & mask];
+				std::uint64_t seq = slot->Sequence.load(std::memory_order_acquire);
+				std::int64_t diff = static_cast<std::int64_t>(seq) - static_cast<std::int64_t>(pos);
+				if (diff == 0) {
+					// slot is free, try to claim it
+					if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+				} else if (diff < 0) {
+					// slot still holds a signal not yet popped -> queue is full
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				} else {
+					// another producer claimed the slot
+					pos = enqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+			slot->Signal = signal;
+			slot->Sender = sender;
+			payloadSize.fetch_add(signalPayloadSize(signal), std::memory_order_relaxed);
+			slot->Sequence.store(pos + 1, std::memory_order_release);
+			count.fetch_add(1, std::memory_order_release);
+			return true;
+		}
+
+		bool SignalQueue::pop(FFINDynamicStructHolder& signal, FFINNetworkTrace& sender) {
+			Slot* slot = &slots[dequeuePos & mask];
+			std::uint64_t seq = slot->Sequence.load(std::memory_order_acquire);
+			if (seq != dequeuePos + 1) return false; // slot not yet published
+			signal = slot->Signal;
+			sender = slot->Sender;
+			payloadSize.fetch_sub(signalPayloadSize(signal), std::memory_order_relaxed);
+			slot->Signal = FFINDynamicStructHolder();
+			slot->Sender = FFINNetworkTrace();
+			slot->Sequence.store(dequeuePos + capacity, std::memory_order_release);
+			++dequeuePos;
+			count.fetch_sub(1, std::memory_order_release);
+			return true;
+		}
+
+		int32 SignalQueue::popBatch(TArray<TPair<FFINDynamicStructHolder, FFINNetworkTrace>>& out, int32 max) {
+			int32 popped = 0;
+			FFINDynamicStructHolder signal;
+			FFINNetworkTrace sender;
+			while (popped < max && pop(signal, sender)) {
+				out.Add(TPair<FFINDynamicStructHolder, FFINNetworkTrace>{signal, sender});
+				++popped;
+			}
+			return popped;
+		}
+
+		void SignalQueue::clear() {
+			FFINDynamicStructHolder signal;
+			FFINNetworkTrace sender;
+			while (pop(signal, sender)) {}
+		}
+
+		void SignalQueue::resize(std::uint32_t newCapacity) {
+			TArray<TPair<FFINDynamicStructHolder, FFINNetworkTrace>> kept;
+			popBatch(kept, MAX_int32);
+			release();
+			allocate(newCapacity);
+			for (const TPair<FFINDynamicStructHolder, FFINNetworkTrace>& signal : kept) {
+				push(signal.Key, signal.Value);
+			}
+		}
+
+		std::uint32_t SignalQueue::size() const {
+			return count.load(std::memory_order_acquire);
+		}
+
+		std::uint32_t SignalQueue::getCapacity() const {
+			return capacity;
+		}
+
+		std::uint64_t SignalQueue::getDropped() const {
+			return dropped.load(std::memory_order_relaxed);
+		}
+
+		std::int64_t SignalQueue::getMemoryUsage() const {
+			return static_cast<std::int64_t>(capacity) * sizeof(Slot) + payloadSize.load(std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+#include <cstdint>
+
+#include "Network/FINDynamicStructHolder.h"
+#include "Network/FINNetworkTrace.h"
+#include "Network/Signals/FINSignal.h"
+
+namespace FicsItKernel {
+	namespace Network {
+		/**
+		 * Bounded lock-free multi-producer single-consumer queue of signals and their senders.
+		 * Any thread is allowed to push signals, but only the owning kernel is allowed to pop them.
+		 * Signals pushed while the queue is full get dropped and counted.
+		 */
+		class SignalQueue {
+		private:
+			struct Slot {
+				std::atomic<std::uint64_t> Sequence;
+				FFINDynamicStructHolder Signal;
+				FFINNetworkTrace Sender;
+			};
+
+			Slot* slots = nullptr;
+			std::uint64_t mask = 0;
+			std::uint32_t capacity = 0;
+			alignas(64) std::atomic<std::uint64_t> enqueuePos{0};
+			alignas(64) std::uint64_t dequeuePos = 0;
+			std::atomic<std::uint32_t> count{0};
+			std::atomic<std::uint64_t> dropped{0};
+			std::atomic<std::int64_t> payloadSize{0};
+
+			void allocate(std::uint32_t capacity);
+			void release();
+
+		public:
+			/**
+			 * Creates a new signal queue able to hold the given amount of signals.
+			 */
+			SignalQueue(std::uint32_t capacity);
+			SignalQueue(const SignalQueue&) = delete;
+			SignalQueue& operator=(const SignalQueue&) = delete;
+			~SignalQueue();
+
+			/**
+			 * Pushes a signal to the queue.
+			 * Thread safe.
+			 *
+			 * @param[in]	signal	the signal you want to push
+			 * @param[in]	sender	the sender of the signal
+			 * @return	false if the queue was full and the signal got dropped
+			 */
+			bool push(const FFINDynamicStructHolder& signal, const FFINNetworkTrace& sender);
+
+			/**
+			 * Pops the oldest signal from the queue.
+			 * Only allowed to get called by the consumer.
+			 *
+			 * @param[out]	signal	the popped signal
+			 * @param[out]	sender	the sender of the popped signal
+			 * @return	false if there was no signal to pop
+			 */
+			bool pop(FFINDynamicStructHolder& signal, FFINNetworkTrace& sender);
+
+			/**
+			 * Pops up to the given amount of signals from the queue and appends them to the given array.
+			 * Only allowed to get called by the consumer.
+			 *
+			 * @param[out]	out		the array the signals get appended to
+			 * @param[in]	max		the max amount of signals to pop
+			 * @return	the amount of popped signals
+			 */
+			int32 popBatch(TArray<TPair<FFINDynamicStructHolder, FFINNetworkTrace>>& out, int32 max);
+
+			/**
+			 * Removes all signals from the queue.
+			 * Only allowed to get called by the consumer.
+			 */
+			void clear();
+
+			/**
+			 * Changes the amount of signals the queue is able to hold.
+			 * Signals already in the queue are kept as long as they fit.
+			 * Not thread safe, no signals are allowed to get pushed while resizing.
+			 *
+			 * @param[in]	capacity	the new capacity, gets rounded up to the next power of two
+			 */
+			void resize(std::uint32_t capacity);
+
+			/**
+			 * Returns the amount of signals ready to get popped.
+			 */
+			std::uint32_t size() const;
+
+			/**
+			 * Returns the amount of signals the queue is able to hold.
+			 */
+			std::uint32_t getCapacity() const;
+
+			/**
+			 * Returns the amount of signals dropped because the queue was full.
+			 */
+			std::uint64_t getDropped() const;
+
+			/**
+			 * Returns the amount of memory used by the queue storage
+			 * and the payloads of the queued signals.
+			 */
+			std::int64_t getMemoryUsage() const;
+		};
+	}
+}
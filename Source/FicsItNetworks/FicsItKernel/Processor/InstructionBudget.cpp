@@ -0,0 +1,35 @@
+#include "InstructionBudget.h"
+
+namespace FicsItKernel {
+	void InstructionBudget::beginFrame(std::int64_t budget) {
+		FScopeLock Lock(&mutex);
+		this->budget = budget;
+		if (budget > 0) {
+			// kernels which were busy in the last frame share the budget, all others get their slice out of the returned instructions
+			const std::int64_t weight = FMath::Max<std::int64_t>(busyWeight, 1);
+			shareRatio = FMath::Min(1.0, static_cast<double>(budget) / static_cast<double>(weight));
+			available = budget;
+			reserved = FMath::Min(budget, weight);
+		}
+		busyWeight = 0;
+	}
+
+	std::int64_t InstructionBudget::acquire(std::int64_t weight) {
+		FScopeLock Lock(&mutex);
+		if (budget <= 0) return weight;
+		const std::int64_t share = FMath::Min(static_cast<std::int64_t>(weight * shareRatio), reserved);
+		reserved -= share;
+		// instructions neither reserved for the shares of other kernels nor used yet, got donated by idle kernels
+		const std::int64_t donated = FMath::Max<std::int64_t>(available - share - reserved, 0);
+		const std::int64_t slice = FMath::Max<std::int64_t>(FMath::Min(share + donated, FMath::Min(weight, available)), 0);
+		available -= slice;
+		return slice;
+	}
+
+	void InstructionBudget::release(std::int64_t weight, std::int64_t slice, std::int64_t used) {
+		FScopeLock Lock(&mutex);
+		if (used > 0) busyWeight += weight;
+		if (budget <= 0) return;
+		available += slice - used;
+	}
+}
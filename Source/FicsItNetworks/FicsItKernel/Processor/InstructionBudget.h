@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include "CoreMinimal.h"
+
+namespace FicsItKernel {
+	/**
+	 * Global budget of processor instructions all kernels share per frame.
+	 * Every kernel tick gets a slice of the budget weighted by the instructions per tick of its processor.
+	 * Slices are based on the weights of the kernels which were busy in the last frame,
+	 * so idle kernels don't hold back instructions busy kernels could use.
+	 * Instructions a kernel tick doesn't use get returned to the budget and can be used by
+	 * busy kernels ticking later in the frame, up to the instructions per tick of their processor.
+	 * The total amount of instructions handed out per frame never exceeds the budget.
+	 * Thread safe, kernels ticking in parallel can share the same budget.
+	 */
+	class InstructionBudget {
+	private:
+		FCriticalSection mutex;
+		std::int64_t budget = 0;
+		std::int64_t available = 0;
+		std::int64_t reserved = 0;
+		double shareRatio = 1.0;
+		std::int64_t busyWeight = 0;
+
+	public:
+		/**
+		 * Starts a new frame with the given budget.
+		 * Has to be called while no kernel ticks.
+		 *
+		 * @param[in]	budget	the instructions all kernels are allowed to execute in the frame, 0 or less for unlimited
+		 */
+		void beginFrame(std::int64_t budget);
+
+		/**
+		 * Takes a slice of instructions for a kernel tick out of the budget.
+		 * The slice has to get returned with release once the tick is done.
+		 *
+		 * @param[in]	weight	the instructions per tick of the processor of the kernel
+		 * @return	the instructions the kernel is allowed to execute in this tick, 0 if the kernel should skip the tick
+		 */
+		std::int64_t acquire(std::int64_t weight);
+
+		/**
+		 * Returns the unused instructions of a slice to the budget.
+		 * Instructions used above the slice get taken from the budget.
+		 *
+		 * @param[in]	weight	the instructions per tick of the processor of the kernel
+		 * @param[in]	slice	the slice acquired for the tick
+		 * @param[in]	used	the instructions the kernel actually executed in the tick
+		 */
+		void release(std::int64_t weight, std::int64_t slice, std::int64_t used);
+	};
+}
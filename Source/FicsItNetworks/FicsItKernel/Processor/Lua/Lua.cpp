@@ -74,6 +74,24 @@ namespace FicsItKernel {
 			}
 		}
 
+		void luaPushName(lua_State* L, FFINName Name) {
+			// the cache isn't persisted, name ids are only valid for the current session
+			if (lua_getfield(L, LUA_REGISTRYINDEX, "NameCache") != LUA_TTABLE) {
+				lua_pop(L, 1);
+				lua_newtable(L);
+				lua_pushvalue(L, -1);
+				lua_setfield(L, LUA_REGISTRYINDEX, "NameCache");
+			}
+			if (lua_rawgeti(L, -1, Name.GetId()) == LUA_TNIL) {
+				lua_pop(L, 1);
+				const std::string& Str = Name.ToUTF8();
+				lua_pushlstring(L, Str.c_str(), Str.size());
+				lua_pushvalue(L, -1);
+				lua_rawseti(L, -3, Name.GetId());
+			}
+			lua_remove(L, -2);
+		}
+
 		void luaToNetworkValue(lua_State* L, int i, FFINAnyNetworkValue& Val) {
 			switch (lua_type(L, i)) {
 			case LUA_TNIL:
@@ -95,8 +113,8 @@ namespace FicsItKernel {
 				break;
 			}
 			default:
-				FString TypeName = luaL_typename(L, i);
-				UScriptStruct* StructType = FFINLuaStructRegistry::Get().GetType(TypeName);
+				FFINName TypeName;
+				UScriptStruct* StructType = luaGetStructTypeName(L, i, TypeName) ? FFINLuaStructRegistry::Get().GetType(TypeName) : nullptr;
 				if (StructType) {
 					Val = FFINAnyNetworkValue(luaGetStruct(L, i));
 					break;
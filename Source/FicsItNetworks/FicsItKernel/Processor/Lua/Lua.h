@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "LuaException.h"
 #include "Network/FINAnyNetworkValue.h"
+#include "Network/FINName.h"
 
 struct FFINNetworkTrace;
 
@@ -98,5 +99,12 @@ namespace FicsItKernel {
 		 * Trys to convert the lua value at the given index to any kind of network value.
 		 */
 		void luaToNetworkValue(lua_State* L, int i, FFINAnyNetworkValue& Val);
+
+		/**
+		 * Pushes the string of the given name onto the stack.
+		 * The lua strings of names get cached in the registry of the lua state,
+		 * so pushing a name again doesn't need to convert or hash the string.
+		 */
+		void luaPushName(lua_State* L, FFINName Name);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "LuaAllocator.h"
+
+#include "CoreMinimal.h"
+
+namespace FicsItKernel {
+	namespace Lua {
+		const std::size_t LuaAllocator::SizeClasses[SizeClassCount] = {16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512};
+		const std::int8_t LuaAllocator::SizeClassLookup[MaxSmallSize / Granularity + 1] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15};
+
+		LuaAllocator::~LuaAllocator() {
+			clear();
+		}
+
+		int LuaAllocator::getSizeClass(std::size_t size) {
+			if (size > MaxSmallSize) return -1;
+			return SizeClassLookup[(size + Granularity - 1) / Granularity];
+		}
+
+		void* LuaAllocator::allocSmall(int sizeClass) {
+			FreeBlock* block = freeLists[sizeClass];
+			if (block) {
+				freeLists[sizeClass] = block->Next;
+				return block;
+			}
+			std::size_t size = SizeClasses[sizeClass];
+			if (pageCursor + size > pageEnd) {
+				char* page = static_cast<char*>(FMemory::Malloc(PageSize, Granularity));
+				if (!page) return nullptr;
+				pages.push_back(page);
+				pageCursor = page;
+				pageEnd = page + PageSize;
+			}
+			void* mem = pageCursor;
+			pageCursor += size;
+			return mem;
+		}
+
+		void LuaAllocator::freeSmall(void* ptr, int sizeClass) {
+			FreeBlock* block = static_cast<FreeBlock*>(ptr);
+			block->Next = freeLists[sizeClass];
+			freeLists[sizeClass] = block;
+		}
+
+		void* LuaAllocator::alloc(void* ptr, std::size_t osize, std::size_t nsize) {
+			// if ptr is nullptr, osize encodes the type of the object lua wants to allocate
+			if (!ptr) osize = 0;
+			int oldClass = getSizeClass(osize);
+			std::int64_t oldCharge = oldClass >= 0 ? SizeClasses[oldClass] : osize;
+			if (!ptr) oldCharge = 0;
+
+			if (nsize == 0) {
+				if (ptr) {
+					if (oldClass >= 0) freeSmall(ptr, oldClass);
+					else FMemory::Free(ptr);
+					usage -= oldCharge;
+				}
+				return nullptr;
+			}
+
+			int newClass = getSizeClass(nsize);
+			std::int64_t newCharge = newClass >= 0 ? SizeClasses[newClass] : nsize;
+			if (ptr && newClass >= 0 && newClass == oldClass) return ptr;
+
+			// refuse allocation if it would exceed the budget, shrinking is always allowed
+			if (budget != Unlimited && newCharge > oldCharge && usage + newCharge - oldCharge > budget) return nullptr;
+
+			void* block;
+			if (ptr && oldClass < 0 && newClass < 0) {
+				block = FMemory::Realloc(ptr, nsize);
+				if (!block) return nullptr;
+			} else {
+				block = newClass >= 0 ? allocSmall(newClass) : FMemory::Malloc(nsize);
+				if (!block) return nullptr;
+				if (ptr) {
+					FMemory::Memcpy(block, ptr, FMath::Min(osize, nsize));
+					if (oldClass >= 0) freeSmall(ptr, oldClass);
+					else FMemory::Free(ptr);
+				}
+			}
+			usage += newCharge - oldCharge;
+			return block;
+		}
+
+		void LuaAllocator::clear() {
+			for (void* page : pages) FMemory::Free(page);
+			pages.clear();
+			for (FreeBlock*& freeList : freeLists) freeList = nullptr;
+			pageCursor = nullptr;
+			pageEnd = nullptr;
+			usage = 0;
+		}
+
+		void LuaAllocator::setBudget(std::int64_t newBudget) {
+			budget = newBudget;
+		}
+
+		std::int64_t LuaAllocator::getBudget() const {
+			return budget;
+		}
+
+		std::int64_t LuaAllocator::getUsage() const {
+			return usage;
+		}
+
+		void* LuaAllocator::luaAlloc(void* ud, void* ptr, std::size_t osize, std::size_t nsize) {
+			return static_cast<LuaAllocator*>(ud)->alloc(ptr, osize, nsize);
+		}
+	}
+}
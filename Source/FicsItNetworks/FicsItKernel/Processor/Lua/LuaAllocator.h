@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace FicsItKernel {
+	namespace Lua {
+		/**
+		 * Memory allocator used for the lua state of a single kernel.
+		 * Small blocks get served from size-class free lists carved out of pages owned by the allocator,
+		 * bigger blocks get allocated directly.
+		 * Keeps track of the exact amount of bytes handed out and refuses allocations exceeding the budget,
+		 * which causes lua to raise a memory error.
+		 * Not thread safe, the allocator is only meant to be used by the kernel owning it.
+		 */
+		class LuaAllocator {
+		public:
+			static constexpr std::int64_t Unlimited = -1;
+
+		private:
+			static constexpr std::size_t Granularity = 16;
+			static constexpr std::size_t MaxSmallSize = 512;
+			static constexpr std::size_t PageSize = 64 * 1024;
+			static constexpr int SizeClassCount = 16;
+			static const std::size_t SizeClasses[SizeClassCount];
+			static const std::int8_t SizeClassLookup[MaxSmallSize / Granularity + 1];
+
+			struct FreeBlock {
+				FreeBlock* Next;
+			};
+
+			FreeBlock* freeLists[SizeClassCount] = {};
+			std::vector<void*> pages;
+			char* pageCursor = nullptr;
+			char* pageEnd = nullptr;
+
+			std::int64_t usage = 0;
+			std::int64_t budget = Unlimited;
+
+			/**
+			 * Returns the index of the smallest size class able to hold the given size.
+			 * Returns -1 if the size is too big for the small block allocator.
+			 */
+			static int getSizeClass(std::size_t size);
+
+			void* allocSmall(int sizeClass);
+			void freeSmall(void* ptr, int sizeClass);
+
+		public:
+			LuaAllocator() = default;
+			LuaAllocator(const LuaAllocator&) = delete;
+			LuaAllocator& operator=(const LuaAllocator&) = delete;
+			~LuaAllocator();
+
+			/**
+			 * Allocates, reallocates or frees a memory block, following the semantics of lua_Alloc.
+			 *
+			 * @param[in]	ptr		the block you want to reallocate or free, nullptr if a new block should get allocated
+			 * @param[in]	osize	the size of the given block
+			 * @param[in]	nsize	the new size of the block, 0 if the block should get freed
+			 * @return	the new block, nullptr if the block got freed or the allocation was refused
+			 */
+			void* alloc(void* ptr, std::size_t osize, std::size_t nsize);
+
+			/**
+			 * Frees all memory owned by the allocator.
+			 * Only allowed if no lua state is using the allocator anymore.
+			 */
+			void clear();
+
+			/**
+			 * Sets the max amount of bytes the allocator is allowed to hand out.
+			 * Allocations exceeding the budget get refused.
+			 *
+			 * @param[in]	budget	the budget in bytes, Unlimited if the allocations should not be limited
+			 */
+			void setBudget(std::int64_t budget);
+
+			/**
+			 * Returns the max amount of bytes the allocator is allowed to hand out.
+			 *
+			 * @return	the budget in bytes, Unlimited if the allocations are not limited
+			 */
+			std::int64_t getBudget() const;
+
+			/**
+			 * Returns the amount of bytes currently handed out by the allocator.
+			 *
+			 * @return	the memory usage in bytes
+			 */
+			std::int64_t getUsage() const;
+
+			/**
+			 * The lua_Alloc function forwarding to the allocator passed as user data.
+			 */
+			static void* luaAlloc(void* ud, void* ptr, std::size_t osize, std::size_t nsize);
+		};
+	}
+}
@@ -6,6 +6,7 @@
 
 #include "FGPowerCircuit.h"
 
+#include "Lua.h"
 #include "LuaProcessor.h"
 #include "LuaInstance.h"
 #include "Network/FINHookSubsystem.h"
@@ -13,18 +14,76 @@
 
 namespace FicsItKernel {
 	namespace Lua {
-		void luaListen(lua_State* L, FFINNetworkTrace o) {
+		/**
+		 * Adds the signal name at the given index to the names of the given filter.
+		 * Names get looked up without interning them, so scripts can't flood the name table.
+		 * A name no signal has yet can't match, it gets added as the empty name, which no signal has,
+		 * so a filter with only unknown names matches nothing instead of everything.
+		 */
+		void luaAddSignalFilterName(lua_State* L, int index, Network::SignalFilter& filter) {
+			size_t len;
+			const char* name = lua_tolstring(L, index, &len);
+			FFINName Name;
+			if (!FFINName::FindUTF8(name, len, Name)) Name = FFINName();
+			filter.Names.Add(Name);
+		}
+
+		/**
+		 * Reads the signal filter table at the given index.
+		 * The table can contain a "signals" field with a signal name or a list of signal names
+		 * and an "args" field with a table mapping parameter indices (starting at 1) to the values they need to equal.
+		 */
+		void luaGetSignalFilter(lua_State* L, int index, Network::SignalFilter& filter) {
+			index = lua_absindex(L, index);
+			
+			lua_getfield(L, index, "signals");
+			if (lua_isstring(L, -1)) {
+				luaAddSignalFilterName(L, -1, filter);
+			} else if (lua_istable(L, -1)) {
+				lua_pushnil(L);
+				while (lua_next(L, -2) != 0) {
+					if (!lua_isstring(L, -1)) luaL_error(L, "signal names of the filter have to be strings");
+					luaAddSignalFilterName(L, -1, filter);
+					lua_pop(L, 1);
+				}
+			} else if (!lua_isnil(L, -1)) {
+				luaL_error(L, "signals of the filter have to be a string or a table of strings");
+			}
+			lua_pop(L, 1);
+
+			lua_getfield(L, index, "args");
+			if (lua_istable(L, -1)) {
+				lua_pushnil(L);
+				while (lua_next(L, -2) != 0) {
+					if (!lua_isinteger(L, -2) || lua_tointeger(L, -2) < 1) luaL_error(L, "arg indices of the filter have to be positive integers");
+					FFINAnyNetworkValue Value;
+					luaToNetworkValue(L, -1, Value);
+					filter.Args.Add(static_cast<int32>(lua_tointeger(L, -2) - 1), Value);
+					lua_pop(L, 1);
+				}
+			} else if (!lua_isnil(L, -1)) {
+				luaL_error(L, "args of the filter have to be a table");
+			}
+			lua_pop(L, 1);
+		}
+
+		void luaListen(lua_State* L, FFINNetworkTrace o, const Network::SignalFilter& filter, bool bCoalesce) {
 			auto net = LuaProcessor::luaGetProcessor(L)->getKernel()->getNetwork();
 			UObject* obj = *o;
 			if (!IsValid(obj)) luaL_error(L, "object is not valid");
+			net->setSignalFilter(obj, filter);
 			if (obj->Implements<UFINSignalSender>()) {
-				IFINSignalSender::Execute_AddListener(obj, o.Reverse());
+				UFINSignalUtility::AddListener(obj, o.Reverse());
 				UFINSignalUtility::SetupSender(obj->GetClass());
 				AFINHookSubsystem::GetHookSubsystem(obj)->ClassesWithSignals.Add(obj->GetClass());
+
+				// signals may get send in the name of another object
+				UObject* senderOverride = IFINSignalSender::Execute_GetSignalSenderOverride(obj);
+				if (senderOverride && senderOverride != obj) net->setSignalFilter(senderOverride, filter);
 			}
 
 			// Hooks
-			AFINHookSubsystem::GetHookSubsystem(obj)->AddListener(obj, o.Reverse());
+			AFINHookSubsystem::GetHookSubsystem(obj)->AddListener(obj, o.Reverse(), bCoalesce);
 
 			net->signalSenders.Add(o);
 		}
@@ -32,10 +91,26 @@ namespace FicsItKernel {
 		int luaListen(lua_State* L) {
 			int args = lua_gettop(L);
 
+			// a plain table as last argument is the filter for all given components
+			Network::SignalFilter filter;
+			bool bCoalesce = false;
+			if (args > 0 && lua_type(L, args) == LUA_TTABLE) {
+				if (lua_getmetatable(L, args)) {
+					// tables with metatables are structs
+					lua_pop(L, 1);
+				} else {
+					luaGetSignalFilter(L, args, filter);
+					lua_getfield(L, args, "coalesce");
+					bCoalesce = lua_toboolean(L, -1);
+					lua_pop(L, 1);
+					--args;
+				}
+			}
+
 			for (int i = 1; i <= args; ++i) {
 				FFINNetworkTrace trace;
 				auto o = (UObject*)getObjInstance<UObject>(L, i, &trace);
-				luaListen(L, trace / o);
+				luaListen(L, trace / o, filter, bCoalesce);
 			}
 			return LuaProcessor::luaAPIReturn(L, 0);
 		}
@@ -70,9 +145,11 @@ namespace FicsItKernel {
 			auto net = LuaProcessor::luaGetProcessor(L)->getKernel()->getNetwork();
 			UObject* obj = *o;
 			if (!IsValid(obj)) luaL_error(L, "object is not valid");
+			net->removeSignalFilter(obj);
 			if (obj->Implements<UFINSignalSender>()) {
-				IFINSignalSender::Execute_RemoveListener(obj, o.Reverse());
+				UFINSignalUtility::RemoveListener(obj, o.Reverse());
 				net->signalSenders.Remove(o);
+				net->removeSignalFilter(IFINSignalSender::Execute_GetSignalSenderOverride(obj));
 			}
 
 			// Hooks
@@ -97,11 +174,12 @@ namespace FicsItKernel {
 				UObject* s = *sender;
 				if (s) {
 					FFINNetworkTrace listener = sender.Reverse();
-					IFINSignalSender::Execute_RemoveListener(s, listener);
+					UFINSignalUtility::RemoveListener(s, listener);
 					AFINHookSubsystem::GetHookSubsystem(net->component)->RemoveListener(s, net->component);
 				}
 			}
 			net->signalSenders.Empty();
+			net->clearSignalFilters();
 			return 1;
 		}
 
@@ -110,12 +188,34 @@ namespace FicsItKernel {
 			return 0;
 		}
 
+		int luaGetQueueSize(lua_State* L) {
+			lua_pushinteger(L, LuaProcessor::luaGetProcessor(L)->getKernel()->getNetwork()->getMaxSignalCount());
+			return 1;
+		}
+
+		int luaSetQueueSize(lua_State* L) {
+			lua_Integer size = luaL_checkinteger(L, 1);
+			luaL_argcheck(L, size >= 1 && size <= Network::NetworkController::signalCountLimit, 1, "queue size out of range");
+			auto net = LuaProcessor::luaGetProcessor(L)->getKernel()->getNetwork();
+			net->setMaxSignalCount(static_cast<uint32>(size));
+			lua_pushinteger(L, net->getMaxSignalCount());
+			return 1;
+		}
+
+		int luaGetDroppedCount(lua_State* L) {
+			lua_pushinteger(L, static_cast<lua_Integer>(LuaProcessor::luaGetProcessor(L)->getKernel()->getNetwork()->getDroppedSignalCount()));
+			return 1;
+		}
+
 		static const luaL_Reg luaEventLib[] = {
 			{"listen", luaListen},
 			{"pull", luaPull},
 			{"ignore", luaIgnore},
 			{"ignoreAll", luaIgnoreAll},
 			{"clear", luaClear},
+			{"getQueueSize", luaGetQueueSize},
+			{"setQueueSize", luaSetQueueSize},
+			{"getDroppedCount", luaGetDroppedCount},
 			{NULL,NULL}
 		};
 
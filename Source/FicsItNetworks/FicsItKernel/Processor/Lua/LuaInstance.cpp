@@ -4,21 +4,50 @@
 #include "LuaProcessorStateStorage.h"
 
 #include "Network/FINNetworkComponent.h"
+#include "Network/FINFunctionLayout.h"
 #include "Network/FINNetworkCustomType.h"
 #include "Network/FINVariadicParameterList.h"
 #include "util/Logging.h"
 
 #define INSTANCE_TYPE "InstanceType"
 #define INSTANCE_CACHE "InstanceCache"
+#define INSTANCE_DISPATCH "InstanceDispatch"
 #define INSTANCE_UFUNC_DATA "InstanceUFuncData"
 #define CLASS_INSTANCE_FUNC_DATA "ClassInstanceFuncData"
 
+#define INSTANCE_MEMBER_ID 1
+#define INSTANCE_MEMBER_NICK 2
+
 #define OffsetParam(type, off) (type*)((std::uint64_t)param + off)
 
 #pragma optimize("", off)
 namespace FicsItKernel {
 	namespace Lua {
-		std::map<UObject*, std::mutex> objectLocks;
+		/**
+		 * Fixed size table of mutexes serializing reflected calls on the same object across kernels.
+		 * Objects get mapped to one of the stripes by their address, so the table never grows
+		 * and doesn't need to be modified while kernels tick in parallel.
+		 */
+		class LuaObjectLockTable {
+		private:
+			static constexpr uint32 StripeCount = 256;
+
+			struct alignas(PLATFORM_CACHE_LINE_SIZE) Stripe {
+				std::mutex Mutex;
+			};
+
+			Stripe stripes[StripeCount];
+
+		public:
+			std::mutex& get(const UObject* obj) {
+				return stripes[GetTypeHash(obj) % StripeCount].Mutex;
+			}
+		} objectLocks;
+
+		std::mutex& getObjectLock(const UObject* obj) {
+			return objectLocks.get(obj);
+		}
+		
 		
 		LuaInstanceRegistry* LuaInstanceRegistry::get() {
 			static LuaInstanceRegistry* instance = nullptr;
@@ -117,6 +146,18 @@ namespace FicsItKernel {
 			return false;
 		}
 
+		const TMap<FString, LuaLibFunc>* LuaInstanceRegistry::getLibFuncs(UClass* type) const {
+			return instanceFunctions.Find(type);
+		}
+
+		const TMap<FString, LuaLibProperty>* LuaInstanceRegistry::getLibProperties(UClass* type) const {
+			return instanceProperties.Find(type);
+		}
+
+		const TMap<FString, LuaLibClassFunc>* LuaInstanceRegistry::getClassLibFuncs(UClass* type) const {
+			return classInstanceFunctions.Find(type);
+		}
+
 		LuaInstance* LuaInstanceRegistry::getInstance(lua_State* L, int index, std::string* name) {
 			index = lua_absindex(L, index);
 			FString typeName;
@@ -250,7 +291,21 @@ namespace FicsItKernel {
 			luaL_setmetatable(L, INSTANCE_TYPE);
 		}
 
-		int luaInstanceFuncCall(lua_State* L) {		// Instance, args..., up: FuncName, up: InstanceType
+		int luaInstanceFuncCall(lua_State* L) {		// Instance, args..., up: FuncName, up: InstanceType, up: LibFunc, up: InstanceMeta
+			// functions of the dispatch table have the lib function bound, so instances of the exact type only need a metatable compare
+			const LuaLibFunc* boundFunc = static_cast<const LuaLibFunc*>(lua_touserdata(L, lua_upvalueindex(3)));
+			if (boundFunc && lua_getmetatable(L, 1)) {
+				const bool bSameType = lua_rawequal(L, -1, lua_upvalueindex(4));
+				lua_pop(L, 1);
+				if (bSameType) {
+					LuaInstance* instance = static_cast<LuaInstance*>(lua_touserdata(L, 1));
+					if (!IsValid(*instance->Trace)) return luaL_argerror(L, 1, "Instance is invalid");
+					lua_remove(L, 1);
+					int args = (*boundFunc)(L, lua_gettop(L), instance);
+					return LuaProcessor::luaAPIReturn(L, args);
+				}
+			}
+			
 			LuaInstanceRegistry* reg = LuaInstanceRegistry::get();
 
 			// get and check instance
@@ -296,56 +351,51 @@ namespace FicsItKernel {
 				if (!comp->GetClass()->IsChildOf(funcClass)) return luaL_argerror(L, 1, "Instance type is not allowed to call this function");;
 				
 				// allocate parameter space
-				void* params = FMemory::Malloc(func->ParmsSize);
-				func->InitializeStruct(params);
+				const FFINFunctionLayout& layout = FFINFunctionLayout::Get(func);
+				LuaParameterStack& stack = LuaProcessor::luaGetProcessor(L)->getParameterStack();
+				void* params = stack.push(layout.ParmsSize, layout.Alignment);
+				layout.Initialize(params);
 	
 				// init and set parameter values
 				int i = 2;
-				for (auto property = TFieldIterator<UProperty>(func); property; ++property) {
-					auto flags = property->GetPropertyFlags();
-					if (flags & CPF_Parm && !(flags & (CPF_OutParm | CPF_ReturnParm))) {
-						UStructProperty* StructProp = Cast<UStructProperty>(*property);
-						if (StructProp && StructProp->Struct == FFINDynamicStructHolder::StaticStruct()) {
-							// Variadic Parameters now
-							TFINDynamicStruct<FFINVariadicParameterList> VariadicParams;
-							int paramCount = lua_gettop(L);
-							while (i <= paramCount) {
-								FFINAnyNetworkValue Val;
-								luaToNetworkValue(L, i++, Val);
-								VariadicParams->Add(Val);
-							}
-							FFINDynamicStructHolder& Params = *StructProp->ContainerPtrToValuePtr<FFINDynamicStructHolder>(params);
-							Params = VariadicParams;
-						} else {
-							try {
-								luaToProperty(L, *property, params, i++);
-							} catch (std::exception e) {
-								func->DestroyStruct(params);
-								FMemory::Free(params);
-								return luaL_error(L, ("Argument #" + std::to_string(i) + " is not of type " + e.what()).c_str());
-							}
+				for (UProperty* property : layout.InParams) {
+					if (property == layout.VariadicParam) {
+						// Variadic Parameters now
+						TFINDynamicStruct<FFINVariadicParameterList> VariadicParams;
+						int paramCount = lua_gettop(L);
+						while (i <= paramCount) {
+							FFINAnyNetworkValue Val;
+							luaToNetworkValue(L, i++, Val);
+							VariadicParams.GetMutable<FFINVariadicParameterList>().Add(Val);
+						}
+						FFINDynamicStructHolder& Params = *layout.VariadicParam->ContainerPtrToValuePtr<FFINDynamicStructHolder>(params);
+						Params = VariadicParams;
+					} else {
+						try {
+							luaToProperty(L, property, params, i++);
+						} catch (std::exception e) {
+							layout.Destroy(params);
+							stack.pop(params);
+							return luaL_error(L, ("Argument #" + std::to_string(i) + " is not of type " + e.what()).c_str());
 						}
 					}
 				}
 	
 				// execute native function only if no error
 				{
-					std::lock_guard<std::mutex> m(objectLocks[comp]);
+					std::lock_guard<std::mutex> m(getObjectLock(comp));
 					comp->ProcessEvent(func, params);
 				}
 				
 				int retargs = 0;
 				// free parameters and eventualy push return values to lua
-				for (auto property = TFieldIterator<UProperty>(func); property; ++property) {
-					auto flags = property->GetPropertyFlags();
-					if (flags & CPF_Parm && flags & (CPF_OutParm | CPF_ReturnParm)) {
-						propertyToLua(L, *property, params, trace);
-						++retargs;
-					}
+				for (UProperty* property : layout.OutParams) {
+					propertyToLua(L, property, params, trace);
+					++retargs;
 				}
 				
-				func->DestroyStruct(params);
-				FMemory::Free(params);
+				layout.Destroy(params);
+				stack.pop(params);
 				
 				return LuaProcessor::luaAPIReturn(L, retargs);
 			}
@@ -361,136 +411,157 @@ namespace FicsItKernel {
 				lua_pushcclosure(L, luaInstanceUFuncCall, 2);													// Instance, FuncName, InstanceCache, nil, InstanceFunc
 
 				// cache function
-				lua_pushvalue(L, -1);																			// Instance, FuncName, InstanceCache, nil, InstanceFunc, InstanceFunc
-				lua_setfield(L, 3, TCHAR_TO_UTF8(*funcName));														// Instance, FuncName, InstanceCache, nil, InstanceFunc
+				lua_pushvalue(L, 2);																			// Instance, FuncName, InstanceCache, nil, InstanceFunc, FuncName
+				lua_pushvalue(L, -2);																			// Instance, FuncName, InstanceCache, nil, InstanceFunc, FuncName, InstanceFunc
+				lua_rawset(L, 3);																				// Instance, FuncName, InstanceCache, nil, InstanceFunc
 
 				return true;
 			}
 			return false;
 		}
 
-		int luaInstanceIndex(lua_State* L) {																			// Instance, FuncName
-			LuaInstanceRegistry* reg = LuaInstanceRegistry::get();
+		/**
+		 * Checks if the value at the given index is a instance using the metatable passed as first upvalue
+		 * to the metamethod. Causes a lua arg error if it's not.
+		 */
+		LuaInstance* luaCheckDispatchInstance(lua_State* L, int index) {
+			if (!lua_getmetatable(L, index) || !lua_rawequal(L, -1, lua_upvalueindex(1))) {
+				luaL_argerror(L, index, "'Instance' expected");
+			}
+			lua_pop(L, 1);
+			return static_cast<LuaInstance*>(lua_touserdata(L, index));
+		}
 
-			// get instance
-			std::string typeName;
-			LuaInstance* instance = reg->checkAndGetInstance(L, 1, &typeName);
-			UClass* type = reg->findType(typeName.c_str());
+		int luaInstanceIndex(lua_State* L) {																			// Instance, MemberName, up: InstanceMeta, up: InstanceDispatch
+			LuaInstance* instance = luaCheckDispatchInstance(L, 1);
 				
-			// get function name
+			// get member name
 			if (!lua_isstring(L, 2)) return 0;
-			std::string memberName = lua_tostring(L, 2);
 
 			UObject* obj = *instance->Trace;
-			UObject* org = instance->Orignal.Get();
-
 			if (!IsValid(obj)) {
 				return luaL_error(L, "Instance is invalid");
 			}
-			
-			// try to get property
-			if (memberName == "id") {
-				if (!org || !org->GetClass()->ImplementsInterface(UFINNetworkComponent::StaticClass())) {
-					return luaL_error(L, "Instance is not a network component");
-				}
-				lua_pushstring(L, TCHAR_TO_UTF8(*IFINNetworkComponent::Execute_GetID(org).ToString()));
+
+			// lookup member in dispatch table
+			lua_pushvalue(L, 2);																					// Instance, MemberName, MemberName
+			switch (lua_rawget(L, lua_upvalueindex(2))) {															// Instance, MemberName, Member
+			case LUA_TFUNCTION:
 				return LuaProcessor::luaAPIReturn(L, 1);
-			}
-			if (memberName == "nick") {
+			case LUA_TLIGHTUSERDATA: {
+				const LuaLibProperty* libProp = static_cast<const LuaLibProperty*>(lua_touserdata(L, -1));
+				FFINNetworkTrace realTrace = instance->Trace;
+				lua_pop(L, 3);
+				return LuaProcessor::luaAPIReturn(L, libProp->get(L, realTrace));
+			} case LUA_TNUMBER: {
+				UObject* org = instance->Orignal.Get();
 				if (!org || !org->GetClass()->ImplementsInterface(UFINNetworkComponent::StaticClass())) {
 					return luaL_error(L, "Instance is not a network component");
 				}
-				lua_pushstring(L, TCHAR_TO_UTF8(*IFINNetworkComponent::Execute_GetNick(org)));
+				if (lua_tointeger(L, -1) == INSTANCE_MEMBER_ID) {
+					lua_pushstring(L, TCHAR_TO_UTF8(*IFINNetworkComponent::Execute_GetID(org).ToString()));
+				} else {
+					lua_pushstring(L, TCHAR_TO_UTF8(*IFINNetworkComponent::Execute_GetNick(org)));
+				}
 				return LuaProcessor::luaAPIReturn(L, 1);
-			}
-
-			// try to find lib property
-			LuaLibProperty libProp;
-			FFINNetworkTrace realTrace = instance->Trace;
-			bool foundLibProp = false;
-			if (reg->findLibProperty(reg->findType(typeName.c_str()), memberName.c_str(), libProp)) {
-				foundLibProp = true;
-			}
-			if (foundLibProp) {
-				lua_pop(L, 2);
-				return LuaProcessor::luaAPIReturn(L, libProp.get(L, realTrace));
+			} default:
+				lua_pop(L, 1);																						// Instance, MemberName
 			}
 
 			// get cache function
-			luaL_getmetafield(L, 1, INSTANCE_CACHE);																// Instance, FuncName, InstanceCache
-			if (lua_getfield(L, -1, memberName.c_str()) != LUA_TNIL) {												// Instance, FuncName, InstanceCache, CachedFunc
+			luaL_getmetafield(L, 1, INSTANCE_CACHE);																// Instance, MemberName, InstanceCache
+			lua_pushvalue(L, 2);																					// Instance, MemberName, InstanceCache, MemberName
+			if (lua_rawget(L, -2) != LUA_TNIL) {																	// Instance, MemberName, InstanceCache, CachedFunc
 				return LuaProcessor::luaAPIReturn(L, 1);
-			}																											// Instance, FuncName, InstanceCache, nil
-			
-			// get lib function
-			LuaLibFunc libFunc;
-			bool foundLibFunc = false;
-			if (reg->findLibFunc(reg->findType(typeName.c_str()), memberName.c_str(), libFunc)) {
-				foundLibFunc = true;
-			}
-			if (foundLibFunc) {
-				// create function
-				lua_pushvalue(L, 2);																				// Instance, FuncName, InstanceCoche, nil, FuncName
-				luaInstanceType(L, LuaInstanceType{type});																// Instance, FuncName, InstanceCache, nil, FuncName, InstanceType
-				lua_pushcclosure(L, luaInstanceFuncCall, 2);															// Instance, FuncName, InstanceCache, nil, InstanceFunc
-
-				// cache function
-				lua_pushvalue(L, -1);																				// Instance, FuncName, InstanceCache, nil, InstanceFunc, InstanceFunc
-				lua_setfield(L, 3, memberName.c_str());															// Instance, FuncName, InstanceCache, nil, InstanceFunc
-
-				return LuaProcessor::luaAPIReturn(L, 1);
-			}
+			}																											// Instance, MemberName, InstanceCache, nil
 
 			// get reflected function
 			UClass* instType = obj->GetClass();
-			if (luaInstanceIndexFindUFunction(L, instType, memberName.c_str(), reg)) return LuaProcessor::luaAPIReturn(L, 1);
+			if (luaInstanceIndexFindUFunction(L, instType, lua_tostring(L, 2), LuaInstanceRegistry::get())) return LuaProcessor::luaAPIReturn(L, 1);
 			
 			return LuaProcessor::luaAPIReturn(L, 0);
 		}
 
-		int luaInstanceNewIndex(lua_State* L) {
-			LuaInstanceRegistry* reg = LuaInstanceRegistry::get();
-
-			// get instance
-			std::string typeName;
-			LuaInstance* instance = reg->checkAndGetInstance(L, 1, &typeName);
-			UClass* type = reg->findType(typeName.c_str());
+		int luaInstanceNewIndex(lua_State* L) {																			// Instance, MemberName, Value, up: InstanceMeta, up: InstanceDispatch
+			LuaInstance* instance = luaCheckDispatchInstance(L, 1);
 				
-			// get function name
+			// get member name
 			if (!lua_isstring(L, 2)) return 0;
-			std::string memberName = lua_tostring(L, 2);
 
 			UObject* obj = *instance->Trace;
-			UObject* Org = instance->Orignal.Get();
-
 			if (!IsValid(obj)) {
 				return luaL_error(L, "Instance is invalid");
 			}
-			
-			if (memberName == "nick") {
-				if (!Org && !Org->GetClass()->ImplementsInterface(UFINNetworkComponent::StaticClass())) {
+
+			// lookup member in dispatch table
+			lua_pushvalue(L, 2);																					// Instance, MemberName, Value, MemberName
+			switch (lua_rawget(L, lua_upvalueindex(2))) {															// Instance, MemberName, Value, Member
+			case LUA_TLIGHTUSERDATA: {
+				const LuaLibProperty* libProp = static_cast<const LuaLibProperty*>(lua_touserdata(L, -1));
+				if (libProp->readOnly) return luaL_error(L, "property is read only");
+				FFINNetworkTrace realTrace = instance->Trace;
+				lua_pop(L, 1);
+				lua_remove(L, 1);
+				lua_remove(L, 1);
+				return LuaProcessor::luaAPIReturn(L, libProp->set(L, realTrace));
+			} case LUA_TNUMBER: {
+				if (lua_tointeger(L, -1) != INSTANCE_MEMBER_NICK) break;
+				UObject* Org = instance->Orignal.Get();
+				if (!Org || !Org->GetClass()->ImplementsInterface(UFINNetworkComponent::StaticClass())) {
 					return luaL_error(L, "Instance is not a network component");
 				}
 				FString nick = luaL_checkstring(L, 3);
 				IFINNetworkComponent::Execute_SetNick(Org, nick);
 				return LuaProcessor::luaAPIReturn(L, 1);
+			} default:
+				break;
 			}
+			
+			return luaL_error(L, "Instance doesn't have property with name '%s'", lua_tostring(L, 2));
+		}
 
-			// try to find lib property
-			LuaLibProperty libProp;
-			FFINNetworkTrace realTrace = instance->Trace;
-			bool foundLibProp = false;
-			if (reg->findLibProperty(reg->findType(typeName.c_str()), memberName.c_str(), libProp)) {
-				foundLibProp = true;
+		int luaInstanceGetProperties(lua_State* L) {																	// Instance, MemberNames
+			LuaInstance* instance = LuaInstanceRegistry::get()->checkAndGetInstance(L, 1);
+			luaL_checktype(L, 2, LUA_TTABLE);
+			lua_settop(L, 2);
+
+			// validate the instance only once for all members
+			UObject* obj = *instance->Trace;
+			if (!IsValid(obj)) {
+				return luaL_error(L, "Instance is invalid");
 			}
-			if (foundLibProp) {
-				if (libProp.readOnly) return luaL_error(L, "property is read only");
-				lua_remove(L, 1);
-				lua_remove(L, 1);
-				return LuaProcessor::luaAPIReturn(L, libProp.set(L, realTrace));
+			UObject* org = instance->Orignal.Get();
+			bool isComponent = org && org->GetClass()->ImplementsInterface(UFINNetworkComponent::StaticClass());
+			FFINNetworkTrace realTrace = instance->Trace;
+
+			luaL_getmetafield(L, 1, INSTANCE_DISPATCH);																// Instance, MemberNames, InstanceDispatch
+			lua_Integer count = luaL_len(L, 2);
+			lua_createtable(L, 0, static_cast<int>(count));															// Instance, MemberNames, InstanceDispatch, Values
+			for (lua_Integer i = 1; i <= count; ++i) {
+				if (lua_geti(L, 2, i) != LUA_TSTRING) {																// ..., Values, MemberName
+					return luaL_argerror(L, 2, "member names have to be strings");
+				}
+				int nameIdx = lua_gettop(L);
+				lua_pushvalue(L, nameIdx);																			// ..., Values, MemberName, MemberName
+				int memberType = lua_rawget(L, 3);																	// ..., Values, MemberName, Member
+				if (memberType == LUA_TLIGHTUSERDATA) {
+					const LuaLibProperty* libProp = static_cast<const LuaLibProperty*>(lua_touserdata(L, -1));
+					lua_pop(L, 1);																					// ..., Values, MemberName
+					if (libProp->get(L, realTrace) < 1) lua_pushnil(L);											// ..., Values, MemberName, Value...
+					lua_settop(L, nameIdx + 1);																		// ..., Values, MemberName, Value
+				} else if (memberType == LUA_TNUMBER && isComponent) {
+					lua_Integer member = lua_tointeger(L, -1);
+					lua_pop(L, 1);																					// ..., Values, MemberName
+					if (member == INSTANCE_MEMBER_ID) lua_pushstring(L, TCHAR_TO_UTF8(*IFINNetworkComponent::Execute_GetID(org).ToString()));
+					else lua_pushstring(L, TCHAR_TO_UTF8(*IFINNetworkComponent::Execute_GetNick(org)));	// ..., Values, MemberName, Value
+				} else {
+					// functions and unknown members have no value
+					lua_pop(L, 1);
+					lua_pushnil(L);																					// ..., Values, MemberName, nil
+				}
+				lua_rawset(L, nameIdx - 1);																			// ..., Values
 			}
-			
-			return luaL_error(L, ("Instance doesn't have property with name " + memberName + "'").c_str());
+			return LuaProcessor::luaAPIReturn(L, 1);
 		}
 
 		int luaInstanceEQ(lua_State* L) {
@@ -602,8 +673,6 @@ namespace FicsItKernel {
 		}
 
 		static const luaL_Reg luaInstanceLib[] = {
-			{"__index", luaInstanceIndex},
-			{"__newindex", luaInstanceNewIndex},
 			{"__eq", luaInstanceEQ},
 			{"__lt", luaInstanceLt},
 			{"__le", luaInstanceLe},
@@ -679,46 +748,20 @@ namespace FicsItKernel {
 			return 1;
 		}
 		
-		int luaClassInstanceIndex(lua_State* L) {																		// ClassInstance, FuncName
-			LuaInstanceRegistry* reg = LuaInstanceRegistry::get();
-
-			// get class instance
-			std::string typeName;
-			LuaClassInstance* instance = reg->checkAndGetClassInstance(L, 1, &typeName);
-			UClass* type = reg->findType(typeName.c_str());
+		int luaClassInstanceIndex(lua_State* L) {																		// ClassInstance, FuncName, up: InstanceMeta, up: InstanceDispatch
+			// check class instance
+			if (!lua_getmetatable(L, 1) || !lua_rawequal(L, -1, lua_upvalueindex(1))) {
+				return luaL_argerror(L, 1, "'ClassInstance' expected");
+			}
+			lua_pop(L, 1);
 				
 			// get function name
 			if (!lua_isstring(L, 2)) return 0;
-			FString funcName = lua_tostring(L, 2);
-
-			// try util functions
-			if (funcName == "getMembers") {
-				lua_pushcfunction(L, luaClassInstanceGetMembers);
-				return 1;
-			}
-
-			// get cache function
-			luaL_getmetafield(L, 1, INSTANCE_CACHE);																// ClassInstance, FuncName, InstanceCache
-			if (lua_getfield(L, -1, TCHAR_TO_UTF8(*funcName)) != LUA_TNIL) {									// ClassInstance, FuncName, InstanceCache, CachedFunc
-				return LuaProcessor::luaAPIReturn(L, 1);
-			}																											// ClassInstance, FuncName, InstanceCache, nil
-			
-			// get class lib function
-			LuaLibClassFunc libFunc;
-			if (reg->findClassLibFunc(type, funcName, libFunc)) {
-				// create function
-				lua_pushvalue(L, 2);																				// ClassInstance, FuncName, InstanceCoche, nil, FuncName
-				luaInstanceType(L, LuaInstanceType{type});																// ClassInstance, FuncName, InstanceCache, nil, FuncName, InstanceType
-				lua_pushcclosure(L, luaClassInstanceFuncCall, 2);													// ClassInstance, FuncName, InstanceCache, nil, ClassInstanceFunc
-
-				// cache function
-				lua_pushvalue(L, -1);																				// ClassInstance, FuncName, InstanceCache, nil, ClassInstanceFunc, InstanceFunc
-				lua_setfield(L, 3, TCHAR_TO_UTF8(*funcName));													// ClassInstance, FuncName, InstanceCache, nil, ClassInstanceFunc
 
-				return LuaProcessor::luaAPIReturn(L, 1);
-			}
-			
-			return LuaProcessor::luaAPIReturn(L, 0);
+			// lookup function in dispatch table
+			lua_pushvalue(L, 2);																					// ClassInstance, FuncName, FuncName
+			lua_rawget(L, lua_upvalueindex(2));																		// ClassInstance, FuncName, ClassInstanceFunc
+			return LuaProcessor::luaAPIReturn(L, 1);
 		}
 
 		int luaClassInstanceNewIndex(lua_State* L) {
@@ -816,8 +859,6 @@ namespace FicsItKernel {
 		}
 
 		static const luaL_Reg luaClassInstanceLib[] = {
-			{"__index", luaClassInstanceIndex},
-			{"__newindex", luaClassInstanceNewIndex},
 			{"__eq", luaClassInstanceEQ},
 			{"__lt", luaClassInstanceLt},
 			{"__le", luaClassInstanceLe},
@@ -850,6 +891,75 @@ namespace FicsItKernel {
 			return instance->clazz;
 		}
 
+		/**
+		 * Pushes a new dispatch table for the given instance type onto the stack.
+		 * The table contains all members of the type and its super types, members of sub types overriding the ones of super types.
+		 * Lib functions are stored as closures with the lib function and the metatable of the type bound,
+		 * lib properties as light userdata pointing to the property
+		 * and the builtin members "id" and "nick" as their member number.
+		 */
+		void luaInstanceDispatch(lua_State* L, UClass* type, int metaIndex) {
+			LuaInstanceRegistry* reg = LuaInstanceRegistry::get();
+			metaIndex = lua_absindex(L, metaIndex);
+			lua_newtable(L);																						// ..., InstanceDispatch
+			lua_pushinteger(L, INSTANCE_MEMBER_ID);
+			lua_setfield(L, -2, "id");
+			lua_pushinteger(L, INSTANCE_MEMBER_NICK);
+			lua_setfield(L, -2, "nick");
+			lua_pushcfunction(L, luaInstanceGetProperties);
+			lua_setfield(L, -2, "getProperties");
+
+			// properties have priority over functions
+			for (UClass* super = type; super; super = (super == UObject::StaticClass()) ? nullptr : super->GetSuperClass()) {
+				const TMap<FString, LuaLibProperty>* props = reg->getLibProperties(super);
+				if (props) for (const TPair<FString, LuaLibProperty>& prop : *props) {
+					if (lua_getfield(L, -1, TCHAR_TO_UTF8(*prop.Key)) == LUA_TNIL) {
+						lua_pushlightuserdata(L, const_cast<LuaLibProperty*>(&prop.Value));
+						lua_setfield(L, -3, TCHAR_TO_UTF8(*prop.Key));
+					}
+					lua_pop(L, 1);
+				}
+			}
+			for (UClass* super = type; super; super = (super == UObject::StaticClass()) ? nullptr : super->GetSuperClass()) {
+				const TMap<FString, LuaLibFunc>* funcs = reg->getLibFuncs(super);
+				if (funcs) for (const TPair<FString, LuaLibFunc>& func : *funcs) {
+					if (lua_getfield(L, -1, TCHAR_TO_UTF8(*func.Key)) == LUA_TNIL) {
+						lua_pushstring(L, TCHAR_TO_UTF8(*func.Key));										// ..., InstanceDispatch, nil, FuncName
+						luaInstanceType(L, LuaInstanceType{type});											// ..., InstanceDispatch, nil, FuncName, InstanceType
+						lua_pushlightuserdata(L, const_cast<LuaLibFunc*>(&func.Value));						// ..., InstanceDispatch, nil, FuncName, InstanceType, LibFunc
+						lua_pushvalue(L, metaIndex);														// ..., InstanceDispatch, nil, FuncName, InstanceType, LibFunc, InstanceMeta
+						lua_pushcclosure(L, luaInstanceFuncCall, 4);										// ..., InstanceDispatch, nil, InstanceFunc
+						lua_setfield(L, -3, TCHAR_TO_UTF8(*func.Key));
+					}
+					lua_pop(L, 1);
+				}
+			}
+		}
+
+		/**
+		 * Pushes a new dispatch table for the given class instance type onto the stack.
+		 * The table contains closures for all class lib functions of the type and its super types.
+		 */
+		void luaClassInstanceDispatch(lua_State* L, UClass* type) {
+			LuaInstanceRegistry* reg = LuaInstanceRegistry::get();
+			lua_newtable(L);																						// ..., InstanceDispatch
+			lua_pushcfunction(L, luaClassInstanceGetMembers);
+			lua_setfield(L, -2, "getMembers");
+
+			for (UClass* super = type; super; super = (super == UObject::StaticClass()) ? nullptr : super->GetSuperClass()) {
+				const TMap<FString, LuaLibClassFunc>* funcs = reg->getClassLibFuncs(super);
+				if (funcs) for (const TPair<FString, LuaLibClassFunc>& func : *funcs) {
+					if (lua_getfield(L, -1, TCHAR_TO_UTF8(*func.Key)) == LUA_TNIL) {
+						lua_pushstring(L, TCHAR_TO_UTF8(*func.Key));										// ..., InstanceDispatch, nil, FuncName
+						luaInstanceType(L, LuaInstanceType{type});											// ..., InstanceDispatch, nil, FuncName, InstanceType
+						lua_pushcclosure(L, luaClassInstanceFuncCall, 2);									// ..., InstanceDispatch, nil, ClassInstanceFunc
+						lua_setfield(L, -3, TCHAR_TO_UTF8(*func.Key));
+					}
+					lua_pop(L, 1);
+				}
+			}
+		}
+
 		void setupInstanceSystem(lua_State* L) {
 			PersistSetup("InstanceSystem", -2);
 			LuaInstanceRegistry* reg = LuaInstanceRegistry::get();
@@ -867,6 +977,21 @@ namespace FicsItKernel {
 				luaL_setfuncs(L, isClass ? luaClassInstanceLib : luaInstanceLib, 0);
 				lua_newtable(L);															// ..., InstanceMeta, InstanceCache
 				lua_setfield(L, -2, INSTANCE_CACHE);									// ..., InstanceMeta
+
+				// flattened member lookup used by index and newindex
+				lua_pushvalue(L, -1);													// ..., InstanceMeta, InstanceMeta
+				if (isClass) luaClassInstanceDispatch(L, type);							// ..., InstanceMeta, InstanceMeta, InstanceDispatch
+				else luaInstanceDispatch(L, type, -2);
+				// the functions of the dispatch table have pointers bound, so they get persisted by name
+				PersistTable(TCHAR_TO_UTF8(*(typeName + "-Dispatch")), -1);
+				lua_pushvalue(L, -1);													// ..., InstanceMeta, InstanceMeta, InstanceDispatch, InstanceDispatch
+				lua_setfield(L, -4, INSTANCE_DISPATCH);									// ..., InstanceMeta, InstanceMeta, InstanceDispatch
+				lua_pushvalue(L, -2);													// ..., InstanceMeta, InstanceMeta, InstanceDispatch, InstanceMeta
+				lua_pushvalue(L, -2);													// ..., InstanceMeta, InstanceMeta, InstanceDispatch, InstanceMeta, InstanceDispatch
+				lua_pushcclosure(L, isClass ? luaClassInstanceIndex : luaInstanceIndex, 2);		// ..., InstanceMeta, InstanceMeta, InstanceDispatch, Index
+				lua_setfield(L, -4, "__index");											// ..., InstanceMeta, InstanceMeta, InstanceDispatch
+				lua_pushcclosure(L, isClass ? luaClassInstanceNewIndex : luaInstanceNewIndex, 2);	// ..., InstanceMeta, NewIndex
+				lua_setfield(L, -2, "__newindex");										// ..., InstanceMeta
 				PersistTable(TCHAR_TO_UTF8(*typeName), -1);
 				lua_pop(L, 1);															// ...
 			}
@@ -879,6 +1004,8 @@ namespace FicsItKernel {
 			PersistValue("ClassInstanceFuncCall");			// ...
 			lua_pushcfunction(L, luaClassInstanceGetMembers);	// ..., LuaClassInstanceGetMembers
 			PersistValue("ClassInstnaceGetMembers");			// ...
+			lua_pushcfunction(L, luaInstanceGetProperties);		// ..., LuaInstanceGetProperties
+			PersistValue("InstanceGetProperties");			// ...
 			lua_pushcfunction(L, luaInstanceUnpersist);			// ..., LuaInstanceUnpersist
 			PersistValue("InstanceUnpersist");				// ...
 			lua_pushcfunction(L, luaClassInstanceUnpersist);		// ..., LuaClassInstanceUnpersist
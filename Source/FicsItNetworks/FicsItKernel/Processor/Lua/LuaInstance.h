@@ -7,6 +7,7 @@
 
 #include <string>
 #include <map>
+#include <mutex>
 #include <set>
 #include <functional>
 
@@ -196,6 +197,33 @@ namespace FicsItKernel {
 			*/
 			bool findClassLibFunc(UClass* instanceType, FString name, LuaLibClassFunc& outFunc);
 
+			/**
+			 * Returns the lib functions registered directly for the given type.
+			 * Functions of super types are not included.
+			 *
+			 * @param[in]	type	the type you want to get the lib functions of
+			 * @return	pointer to the function map, nullptr if the type has no lib functions
+			 */
+			const TMap<FString, LuaLibFunc>* getLibFuncs(UClass* type) const;
+
+			/**
+			 * Returns the lib properties registered directly for the given type.
+			 * Properties of super types are not included.
+			 *
+			 * @param[in]	type	the type you want to get the lib properties of
+			 * @return	pointer to the property map, nullptr if the type has no lib properties
+			 */
+			const TMap<FString, LuaLibProperty>* getLibProperties(UClass* type) const;
+
+			/**
+			 * Returns the class lib functions registered directly for the given type.
+			 * Functions of super types are not included.
+			 *
+			 * @param[in]	type	the type you want to get the class lib functions of
+			 * @return	pointer to the function map, nullptr if the type has no class lib functions
+			 */
+			const TMap<FString, LuaLibClassFunc>* getClassLibFuncs(UClass* type) const;
+
 			/**
 			 * Checks if the value at the given index in the lua stack is a instance and outputs the pointer
 			 * to the instance if valid, nullptr if it's not a instance.
@@ -276,6 +304,15 @@ namespace FicsItKernel {
 			std::set<FString> getClassFunctionNames(UClass* type);
 		};
 
+		/**
+		 * Returns the mutex used to serialize reflected access to the given object across kernels.
+		 * Multiple objects may share the same mutex.
+		 *
+		 * @param[in]	obj		the object you want to access
+		 * @return	the mutex you have to lock while accessing the object
+		 */
+		std::mutex& getObjectLock(const UObject* obj);
+
 		/**
 		 * Creates a new Lua Instance for the given network trace and pushes it onto the given stack.
 		 * Or pushes nil if not able to create the instance.
@@ -1,5 +1,6 @@
 #include "LuaLib.h"
 
+#include <atomic>
 #include <vector>
 
 
@@ -30,6 +31,7 @@
 #include "Network/FINNetworkComponent.h"
 #include "Network/FINNetworkCustomType.h"
 #include "Utils/FINTimeTableStop.h"
+#include "Utils/FINObjectSideTable.h"
 #include "Utils/FINTrackGraph.h"
 
 #define LuaLibTypeRegName(ClassName) ClassName ## _Reg
@@ -110,13 +112,230 @@
 
 TSet<FWeakObjectPtr> UFINFactoryConnectorHook::Senders;
 bool UFINFactoryConnectorHook::registered = false;
-FCriticalSection UFINFactoryConnectorHook::MutexFactoryGrab;
-TMap<TWeakObjectPtr<UFGFactoryConnectionComponent>, int8> UFINFactoryConnectorHook::FactoryGrabsRunning;
+FCriticalSection UFINFactoryConnectorHook::MutexSenders;
+
+/**
+ * Side table holding the hook slots of the factory connectors.
+ * Adding slots requires to hold the senders mutex.
+ */
+static TFINObjectSideTable<FFINFactoryHookSlot> FactoryHookSlots;
+
+/**
+ * The factory connectors with a grab currently running on this thread.
+ * Grabs nest (Factory_GrabOutput calls Factory_Internal_GrabOutputInventory), but always on the same thread.
+ */
+static thread_local TArray<UFGFactoryConnectionComponent*, TInlineAllocator<4>> FactoryGrabsRunning;
+
+FFINFactoryConnectorStats::FFINFactoryConnectorStats() {
+	Reset();
+}
+
+void FFINFactoryConnectorStats::Reset() {
+	TotalCount.store(0, std::memory_order_relaxed);
+	LastTransfer.store(-1.0, std::memory_order_relaxed);
+	for (std::atomic<uint64>& Bucket : Buckets) Bucket.store(0, std::memory_order_relaxed);
+	for (int32 i = 0; i < ItemTypeSlots; ++i) {
+		ItemTypes[i].store(nullptr, std::memory_order_relaxed);
+		ItemCounts[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+void FFINFactoryConnectorStats::AddItem(UClass* Type, double Time) {
+	TotalCount.fetch_add(1, std::memory_order_relaxed);
+	LastTransfer.store(Time, std::memory_order_relaxed);
+
+	const uint64 Second = static_cast<uint64>(FMath::Max(0.0, Time));
+	const uint64 Stamp = (Second & 0xFFFFFFFF) << 32;
+	std::atomic<uint64>& Bucket = Buckets[Second % RateBuckets];
+	uint64 Old = Bucket.load(std::memory_order_relaxed);
+	uint64 New;
+	do {
+		New = ((Old & 0xFFFFFFFF00000000) == Stamp) ? Old + 1 : Stamp | 1;
+	} while (!Bucket.compare_exchange_weak(Old, New, std::memory_order_relaxed));
+
+	for (int32 i = 0; i < ItemTypeSlots; ++i) {
+		UClass* SlotType = ItemTypes[i].load(std::memory_order_relaxed);
+		if (!SlotType && ItemTypes[i].compare_exchange_strong(SlotType, Type, std::memory_order_relaxed)) SlotType = Type;
+		if (SlotType == Type) {
+			ItemCounts[i].fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+}
+
+double FFINFactoryConnectorStats::GetRate(double Time, int32 Window) const {
+	// the bucket of the current second is still filling up and the ring needs to keep it apart from the oldest one
+	Window = FMath::Clamp(Window, 1, RateBuckets - 1);
+	const uint64 Now = static_cast<uint64>(FMath::Max(0.0, Time));
+	int64 Count = 0;
+	for (uint64 Second = Now - FMath::Min<uint64>(Now, Window); Second < Now; ++Second) {
+		const uint64 Bucket = Buckets[Second % RateBuckets].load(std::memory_order_relaxed);
+		if ((Bucket >> 32) == (Second & 0xFFFFFFFF)) Count += Bucket & 0xFFFFFFFF;
+	}
+	return static_cast<double>(Count) / Window;
+}
+
+void UFINFactoryConnectorHook::SubscribeHooks() {
+	if (registered) return;
+	registered = true;
+
+	SUBSCRIBE_METHOD_MANUAL("?Factory_GrabOutput@UFGFactoryConnectionComponent@@QEAA_NAEAUFInventoryItem@@AEAMV?$TSubclassOf@VUFGItemDescriptor@@@@@Z", UFGFactoryConnectionComponent::Factory_GrabOutput, &FactoryGrabHook);
+	SUBSCRIBE_METHOD(UFGFactoryConnectionComponent::Factory_Internal_GrabOutputInventory, &FactoryGrabInternalHook);
+}
+
+void UFINFactoryConnectorHook::AddHookedConnector(UObject* comp) {
+	FScopeLock Lock(&MutexSenders);
+	FFINFactoryHookSlot* Slot = FactoryHookSlots.FindOrAdd(comp);
+	if (Slot) {
+		Slot->Hooks.fetch_add(1, std::memory_order_relaxed);
+		Slot->Listeners.fetch_add(1, std::memory_order_relaxed);
+	}
+	Senders.Add(comp);
+}
+
+void UFINFactoryConnectorHook::RemoveHookedConnector(UObject* comp) {
+	FScopeLock Lock(&MutexSenders);
+	FFINFactoryHookSlot* Slot = FactoryHookSlots.Find(comp);
+	if (Slot) {
+		Slot->Hooks.fetch_sub(1, std::memory_order_relaxed);
+		Slot->Listeners.fetch_sub(1, std::memory_order_relaxed);
+	}
+	Senders.Remove(comp);
+}
+
+FFINFactoryHookSlot* UFINFactoryConnectorHook::GetHookedSlot(UFGFactoryConnectionComponent* comp) {
+	FFINFactoryHookSlot* Slot = FactoryHookSlots.Find(comp);
+	if (!Slot || Slot->Hooks.load(std::memory_order_relaxed) <= 0) return nullptr;
+	return Slot;
+}
+
+bool UFINFactoryConnectorHook::IsSender(UFGFactoryConnectionComponent* comp) {
+	FScopeLock Lock(&MutexSenders);
+	return Senders.Contains(comp);
+}
+
+void UFINFactoryConnectorHook::LockFactoryGrab(UFGFactoryConnectionComponent* comp) {
+	FactoryGrabsRunning.Push(comp);
+}
+
+bool UFINFactoryConnectorHook::UnlockFactoryGrab(UFGFactoryConnectionComponent* comp) {
+	FactoryGrabsRunning.RemoveSingle(comp);
+	return !FactoryGrabsRunning.Contains(comp);
+}
+
+void UFINFactoryConnectorHook::DoFactoryGrab(UFGFactoryConnectionComponent* c, FFINFactoryHookSlot* slot, FInventoryItem& item) {
+	FFINFactoryConnectorStats* Stats = slot->Stats.load(std::memory_order_acquire);
+	// the object index may have been reused by a new connector, so the counters or senders might belong to a destroyed one
+	if (Stats && Stats->SerialNumber.load(std::memory_order_acquire) == GUObjectArray.IndexToObject(c->GetUniqueID())->GetSerialNumber()) {
+		Stats->AddItem(item.ItemClass, c->GetWorld()->GetTimeSeconds());
+	}
+	// only connectors with listeners need the locked sender lookup, connectors which only count items don't
+	if (slot->Listeners.load(std::memory_order_relaxed) > 0 && IsSender(c)) {
+		AFINHookSubsystem::GetHookSubsystem(c)->EmitSignalCoalesced(c, "ItemTransfer", {FFINAnyNetworkValue(TFINDynamicStruct<FInventoryItem>(item))});
+	}
+}
+
+FFINFactoryConnectorStats* UFINFactoryConnectorHook::GetStats(UFGFactoryConnectionComponent* comp) {
+	FFINFactoryHookSlot* Slot = FactoryHookSlots.Find(comp);
+	const int32 SerialNumber = GUObjectArray.AllocateSerialNumber(comp->GetUniqueID());
+	FFINFactoryConnectorStats* Stats = Slot ? Slot->Stats.load(std::memory_order_acquire) : nullptr;
+	if (Stats && Stats->SerialNumber.load(std::memory_order_acquire) == SerialNumber) return Stats;
+
+	FScopeLock Lock(&MutexSenders);
+	Slot = FactoryHookSlots.FindOrAdd(comp);
+	if (!Slot) return nullptr;
+	Stats = Slot->Stats.load(std::memory_order_acquire);
+	if (Stats && Stats->SerialNumber.load(std::memory_order_acquire) == SerialNumber) return Stats;
+	if (!Stats) {
+		Stats = new FFINFactoryConnectorStats();
+		Slot->Stats.store(Stats, std::memory_order_release);
+	} else {
+		// the counters belonged to a destroyed connector with the same object index, which already enabled counting for the slot
+		Stats->Reset();
+	}
+	if (Stats->SerialNumber.exchange(SerialNumber, std::memory_order_release) == 0) {
+		Slot->Hooks.fetch_add(1, std::memory_order_relaxed);
+	}
+	SubscribeHooks();
+	return Stats;
+}
 
 TSet<FWeakObjectPtr> UFINPowerCircuitHook::Senders;
 bool UFINPowerCircuitHook::registered = false;
 FCriticalSection UFINPowerCircuitHook::Mutex;
-TMap<TWeakObjectPtr<UFGFactoryConnectionComponent>, int8> UFINPowerCircuitHook::FactoryGrabsRunning;
+
+/**
+ * Side table holding the statistics caches of the power circuits.
+ * Adding slots requires to hold the mutex of the power circuit hook.
+ */
+static TFINObjectSideTable<std::atomic<FFINPowerCircuitStatsCache*>> PowerCircuitStatsCaches;
+
+void FFINPowerCircuitStatsCache::Publish(const FFINPowerCircuitSnapshot& Snapshot) {
+	const uint32 Next = Version.load(std::memory_order_relaxed) + 1;
+	Writing.store(Next, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	Snapshots[Next & 1] = Snapshot;
+	Version.store(Next, std::memory_order_release);
+}
+
+FFINPowerCircuitSnapshot FFINPowerCircuitStatsCache::Read() const {
+	FFINPowerCircuitSnapshot Snapshot;
+	uint32 Current = Version.load(std::memory_order_acquire);
+	while (true) {
+		Snapshot = Snapshots[Current & 1];
+		std::atomic_thread_fence(std::memory_order_acquire);
+		// the snapshot we read only gets overwritten by the publish after the next one
+		if (Writing.load(std::memory_order_relaxed) - Current < 2) return Snapshot;
+		Current = Version.load(std::memory_order_acquire);
+	}
+}
+
+void UFINPowerCircuitHook::SubscribeHooks() {
+	if (registered) return;
+	registered = true;
+
+	SUBSCRIBE_METHOD_MANUAL("?TickCircuit@UFGPowerCircuit@@MEAAXM@Z", TickCircuitHook_Decl, &TickCircuitHook);
+}
+
+FFINPowerCircuitStatsCache* UFINPowerCircuitHook::FindStatsCache(UFGPowerCircuit* circuit) {
+	std::atomic<FFINPowerCircuitStatsCache*>* Slot = PowerCircuitStatsCaches.Find(circuit);
+	FFINPowerCircuitStatsCache* Cache = Slot ? Slot->load(std::memory_order_acquire) : nullptr;
+	if (!Cache || Cache->SerialNumber.load(std::memory_order_acquire) != GUObjectArray.IndexToObject(circuit->GetUniqueID())->GetSerialNumber()) return nullptr;
+	return Cache;
+}
+
+FFINPowerCircuitSnapshot UFINPowerCircuitHook::CreateSnapshot(UFGPowerCircuit* circuit) {
+	FPowerCircuitStats Stats;
+	circuit->GetStats(Stats);
+	FFINPowerCircuitSnapshot Snapshot;
+	Snapshot.Production = Stats.PowerProduced;
+	Snapshot.Consumption = Stats.PowerConsumed;
+	Snapshot.Capacity = Stats.PowerProductionCapacity;
+	Snapshot.bFused = circuit->IsFuseTriggered();
+	return Snapshot;
+}
+
+FFINPowerCircuitSnapshot UFINPowerCircuitHook::GetStats(UFGPowerCircuit* circuit) {
+	FFINPowerCircuitStatsCache* Cache = FindStatsCache(circuit);
+	if (Cache) return Cache->Read();
+
+	FScopeLock Lock(&Mutex);
+	const int32 SerialNumber = GUObjectArray.AllocateSerialNumber(circuit->GetUniqueID());
+	std::atomic<FFINPowerCircuitStatsCache*>* Slot = PowerCircuitStatsCaches.FindOrAdd(circuit);
+	if (!Slot) return CreateSnapshot(circuit);
+	Cache = Slot->load(std::memory_order_acquire);
+	if (Cache && Cache->SerialNumber.load(std::memory_order_acquire) == SerialNumber) return Cache->Read();
+	if (!Cache) {
+		Cache = new FFINPowerCircuitStatsCache();
+		Slot->store(Cache, std::memory_order_release);
+	}
+	// a cache of a destroyed circuit with the same object index gets reused, it is not getting published to anymore
+	const FFINPowerCircuitSnapshot Snapshot = CreateSnapshot(circuit);
+	Cache->Publish(Snapshot);
+	Cache->SerialNumber.store(SerialNumber, std::memory_order_release);
+	SubscribeHooks();
+	return Snapshot;
+}
 
 namespace FicsItKernel {
 	namespace Lua {
@@ -434,27 +653,38 @@ namespace FicsItKernel {
 		LuaLibHook(UFGPowerCircuit, UFINPowerCircuitHook)
 
 		LuaLibPropReadonly(UFGPowerCircuit, production, {
-			FPowerCircuitStats stats;
-			self->GetStats(stats);
-			lua_pushnumber(L, stats.PowerProduced);
+			lua_pushnumber(L, UFINPowerCircuitHook::GetStats(self).Production);
 			return 1;
 		})
 		
 		LuaLibPropReadonly(UFGPowerCircuit, consumption, {
-			FPowerCircuitStats stats;
-			self->GetStats(stats);
-			lua_pushnumber(L, stats.PowerConsumed);
+			lua_pushnumber(L, UFINPowerCircuitHook::GetStats(self).Consumption);
 			return 1;
 		})
 		
 		LuaLibPropReadonly(UFGPowerCircuit, capacity, {
-			FPowerCircuitStats stats;
-			self->GetStats(stats);
-			lua_pushnumber(L, stats.PowerProductionCapacity);
+			lua_pushnumber(L, UFINPowerCircuitHook::GetStats(self).Capacity);
 			return 1;
 		})
 
-		LuaLibPropReadonlyBool(UFGPowerCircuit, isFuesed, IsFuseTriggered())
+		LuaLibPropReadonly(UFGPowerCircuit, isFuesed, {
+			lua_pushboolean(L, UFINPowerCircuitHook::GetStats(self).bFused);
+			return 1;
+		})
+
+		LuaLibFunc(UFGPowerCircuit, getStats, {
+			const FFINPowerCircuitSnapshot Stats = UFINPowerCircuitHook::GetStats(self);
+			lua_newtable(L);
+			lua_pushnumber(L, Stats.Production);
+			lua_setfield(L, -2, "production");
+			lua_pushnumber(L, Stats.Consumption);
+			lua_setfield(L, -2, "consumption");
+			lua_pushnumber(L, Stats.Capacity);
+			lua_setfield(L, -2, "capacity");
+			lua_pushboolean(L, Stats.bFused);
+			lua_setfield(L, -2, "isFuesed");
+			return 1;
+		})
 
 		// End UFGPowerCircuit
 
@@ -473,6 +703,41 @@ namespace FicsItKernel {
 			return 1;
 		})
 
+		LuaLibPropReadonly(UFGFactoryConnectionComponent, transferCount, {
+			FFINFactoryConnectorStats* Stats = UFINFactoryConnectorHook::GetStats(self);
+			lua_pushinteger(L, Stats ? Stats->TotalCount.load(std::memory_order_relaxed) : 0);
+			return 1;
+		})
+
+		LuaLibPropReadonly(UFGFactoryConnectionComponent, timeSinceTransfer, {
+			FFINFactoryConnectorStats* Stats = UFINFactoryConnectorHook::GetStats(self);
+			double LastTransfer = Stats ? Stats->LastTransfer.load(std::memory_order_relaxed) : -1.0;
+			lua_pushnumber(L, LastTransfer < 0.0 ? -1.0 : self->GetWorld()->GetTimeSeconds() - LastTransfer);
+			return 1;
+		})
+
+		LuaLibFunc(UFGFactoryConnectionComponent, getTransferredItems, {
+			FFINFactoryConnectorStats* Stats = UFINFactoryConnectorHook::GetStats(self);
+			lua_newtable(L);
+			if (!Stats) return 1;
+			int i = 1;
+			for (int32 Slot = 0; Slot < FFINFactoryConnectorStats::ItemTypeSlots; ++Slot) {
+				UClass* Type = Stats->ItemTypes[Slot].load(std::memory_order_relaxed);
+				int64 Count = Stats->ItemCounts[Slot].load(std::memory_order_relaxed);
+				if (!Type || Count < 1) continue;
+				luaStruct(L, FItemAmount(Type, static_cast<int32>(Count)));
+				lua_seti(L, -2, i++);
+			}
+			return 1;
+		})
+
+		LuaLibFunc(UFGFactoryConnectionComponent, getTransferRate, {
+			int Window = static_cast<int>(luaL_optinteger(L, 1, 10));
+			FFINFactoryConnectorStats* Stats = UFINFactoryConnectorHook::GetStats(self);
+			lua_pushnumber(L, Stats ? Stats->GetRate(self->GetWorld()->GetTimeSeconds(), Window) : 0.0);
+			return 1;
+		})
+
 		// End UFGFactoryConnectionComponent
 
 		// Begin AFGBuildableFactory
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "FGBuildableManufacturer.h"
 #include "FGFactoryConnectionComponent.h"
 #include "FGPowerCircuit.h"
@@ -38,6 +40,88 @@ public:
 	}
 };
 
+/**
+ * Item flow counters of a factory connector.
+ * Updated lock free by the grab hooks, so they stay exact no matter how many items pass
+ * and don't depend on the signal queue of a computer.
+ */
+struct FFINFactoryConnectorStats {
+	/**
+	 * The amount of past seconds kept for the rate calculation.
+	 */
+	static constexpr int32 RateBuckets = 60;
+
+	/**
+	 * The max amount of different item types counted separately.
+	 * Further item types only get counted in the total count.
+	 */
+	static constexpr int32 ItemTypeSlots = 16;
+
+	/**
+	 * The serial number of the connector the counters belong to, 0 if they don't belong to any connector.
+	 */
+	std::atomic<int32> SerialNumber{0};
+
+	std::atomic<int64> TotalCount{0};
+
+	/**
+	 * The game time in seconds of the last transfer, negative if there was no transfer yet.
+	 */
+	std::atomic<double> LastTransfer{-1.0};
+
+	/**
+	 * Item counts per game second.
+	 * The upper 32 bits contain the second the bucket belongs to, the lower 32 bits contain the count.
+	 */
+	std::atomic<uint64> Buckets[RateBuckets];
+
+	std::atomic<UClass*> ItemTypes[ItemTypeSlots];
+	std::atomic<int64> ItemCounts[ItemTypeSlots];
+
+	FFINFactoryConnectorStats();
+
+	/**
+	 * Resets all counters.
+	 * Not allowed to be called while the counters might get updated.
+	 */
+	void Reset();
+
+	/**
+	 * Counts a transfer of an item of the given type at the given game time.
+	 */
+	void AddItem(UClass* Type, double Time);
+
+	/**
+	 * Calculates the average amount of items transferred per second
+	 * in the given count of full seconds before the given game time.
+	 *
+	 * @param[in]	Time	the current game time in seconds
+	 * @param[in]	Window	the amount of seconds you want to average over, gets clamped to the kept amount
+	 * @return	the items per second
+	 */
+	double GetRate(double Time, int32 Window) const;
+};
+
+/**
+ * Slot in the hook side table of the factory connectors.
+ */
+struct FFINFactoryHookSlot {
+	/**
+	 * The count of hooks registered for the connector, plus one if item flow counting is enabled.
+	 */
+	std::atomic<int32> Hooks;
+
+	/**
+	 * The count of hooks registered for the connector, so grabs only look up the signal senders if the connector has listeners.
+	 */
+	std::atomic<int32> Listeners;
+
+	/**
+	 * The item flow counters of the connector, nullptr if they never got requested.
+	 */
+	std::atomic<FFINFactoryConnectorStats*> Stats;
+};
+
 UCLASS()
 class UFINFactoryConnectorHook : public UFINHook {
 	GENERATED_BODY()
@@ -45,69 +129,135 @@ class UFINFactoryConnectorHook : public UFINHook {
 private:
 	UPROPERTY()
 	UObject* Sender;
+
+	bool bRegistered = false;
 	
     static TSet<FWeakObjectPtr> Senders;
 	static bool registered;
 
-	static FCriticalSection MutexFactoryGrab;
-	static TMap<TWeakObjectPtr<UFGFactoryConnectionComponent>, int8> FactoryGrabsRunning;
+	static FCriticalSection MutexSenders;
 
-	static void LockFactoryGrab(UFGFactoryConnectionComponent* comp) {
-		MutexFactoryGrab.Lock();
-		++FactoryGrabsRunning.FindOrAdd(comp);
-		MutexFactoryGrab.Unlock();
-	}
+	/**
+	 * Subscribes the grab hooks if not already done.
+	 */
+	static void SubscribeHooks();
 
-	static bool UnlockFactoryGrab(UFGFactoryConnectionComponent* comp) {
-		MutexFactoryGrab.Lock();
-		int8* i = FactoryGrabsRunning.Find(comp);
-		bool valid = false;
-		if (i) {
-			--*i;
-			valid = (*i <= 0);
-			if (valid) FactoryGrabsRunning.Remove(comp);
-		}
-		MutexFactoryGrab.Unlock();
-		return valid;
-	}
+	/**
+	 * Marks the given factory connector as hooked in the hook side table and adds it to the senders.
+	 */
+	static void AddHookedConnector(UObject* comp);
 
-	static void DoFactoryGrab(UFGFactoryConnectionComponent* c, FInventoryItem& item) {
-		AFINHookSubsystem::GetHookSubsystem(c)->EmitSignal(c, FFINSmartSignal("ItemTransfer", TFINDynamicStruct<FInventoryItem>(item)));
-	}
+	/**
+	 * Unmarks the given factory connector in the hook side table and removes it from the senders.
+	 */
+	static void RemoveHookedConnector(UObject* comp);
+
+	/**
+	 * Returns the slot in the hook side table if the given factory connector is hooked.
+	 * Connectors which are not hooked get rejected by a single lookup in the hook side table
+	 * without any locking, so the grab hooks add almost no overhead for them.
+	 */
+	static FFINFactoryHookSlot* GetHookedSlot(UFGFactoryConnectionComponent* comp);
+
+	/**
+	 * Checks if the given factory connector has listeners the item transfers should be signaled to.
+	 */
+	static bool IsSender(UFGFactoryConnectionComponent* comp);
+
+	static void LockFactoryGrab(UFGFactoryConnectionComponent* comp);
+	static bool UnlockFactoryGrab(UFGFactoryConnectionComponent* comp);
+
+	static void DoFactoryGrab(UFGFactoryConnectionComponent* c, FFINFactoryHookSlot* slot, FInventoryItem& item);
 
 	static void FactoryGrabHook(CallScope<bool(*)(UFGFactoryConnectionComponent*, FInventoryItem&, float&, TSubclassOf<UFGItemDescriptor>)>& scope, UFGFactoryConnectionComponent* c, FInventoryItem& item, float& offset, TSubclassOf<UFGItemDescriptor> type) {
-		if (!Senders.Contains(c)) return;
+		FFINFactoryHookSlot* slot = GetHookedSlot(c);
+		if (!slot) return;
 		LockFactoryGrab(c);
 		scope(c, item, offset, type);
 		if (UnlockFactoryGrab(c) && scope.getResult()) {
-			DoFactoryGrab(c, item);
+			DoFactoryGrab(c, slot, item);
 		}
 	}
 
 	static void FactoryGrabInternalHook(CallScope<bool(*)(UFGFactoryConnectionComponent*, FInventoryItem&, TSubclassOf<UFGItemDescriptor>)>& scope, UFGFactoryConnectionComponent* c, FInventoryItem& item, TSubclassOf< UFGItemDescriptor > type) {
-		if (!Senders.Contains(c)) return;
+		FFINFactoryHookSlot* slot = GetHookedSlot(c);
+		if (!slot) return;
 		LockFactoryGrab(c);
 		scope(c, item, type);
 		if (UnlockFactoryGrab(c) && scope.getResult()) {
-			DoFactoryGrab(c, item);
+			DoFactoryGrab(c, slot, item);
 		}
 	}
 			
 public:		
 	void Register(UObject* sender) override {
-    	Senders.Add(Sender = sender);
-
-		if (!registered) {
-			registered = true;
-
-			SUBSCRIBE_METHOD_MANUAL("?Factory_GrabOutput@UFGFactoryConnectionComponent@@QEAA_NAEAUFInventoryItem@@AEAMV?$TSubclassOf@VUFGItemDescriptor@@@@@Z", UFGFactoryConnectionComponent::Factory_GrabOutput, &FactoryGrabHook);
-			SUBSCRIBE_METHOD(UFGFactoryConnectionComponent::Factory_Internal_GrabOutputInventory, &FactoryGrabInternalHook);
-		}
+		if (bRegistered) return;
+		bRegistered = true;
+		AddHookedConnector(Sender = sender);
+		SubscribeHooks();
     }
 		
 	void Unregister() override {
-    	Senders.Remove(Sender);
+		if (!bRegistered) return;
+		bRegistered = false;
+		RemoveHookedConnector(Sender);
     }
+
+	/**
+	 * Returns the item flow counters of the given factory connector.
+	 * Counting starts with the first request of the counters of a connector
+	 * and continues as long as the connector exists.
+	 *
+	 * @param[in]	comp	the factory connector you want to get the counters of
+	 * @return	the counters of the connector, nullptr if the connector can not get tracked
+	 */
+	static FFINFactoryConnectorStats* GetStats(UFGFactoryConnectionComponent* comp);
+};
+
+/**
+ * The statistics of a power circuit at the end of a circuit tick.
+ */
+struct FFINPowerCircuitSnapshot {
+	float Production = 0.0f;
+	float Consumption = 0.0f;
+	float Capacity = 0.0f;
+	bool bFused = false;
+};
+
+/**
+ * Double buffered statistics snapshot of a power circuit.
+ * Gets published once per circuit tick and allows readers on any thread to read it without locking.
+ * Readers retry if the snapshot they read got overwritten in the meantime, which can only happen
+ * if two circuit ticks got published while reading.
+ */
+struct FFINPowerCircuitStatsCache {
+	/**
+	 * The serial number of the circuit the cache belongs to, 0 if it doesn't belong to any circuit.
+	 */
+	std::atomic<int32> SerialNumber{0};
+
+	/**
+	 * The count of published snapshots, the lowest bit is the index of the latest snapshot.
+	 */
+	std::atomic<uint32> Version{0};
+
+	/**
+	 * The version of the snapshot currently getting written, or of the latest one if no snapshot gets written.
+	 */
+	std::atomic<uint32> Writing{0};
+
+	FFINPowerCircuitSnapshot Snapshots[2];
+
+	/**
+	 * Publishes a new snapshot.
+	 * Only allowed to be called by one thread at a time.
+	 */
+	void Publish(const FFINPowerCircuitSnapshot& Snapshot);
+
+	/**
+	 * Returns the latest published snapshot.
+	 */
+	FFINPowerCircuitSnapshot Read() const;
 };
 
 UCLASS()
@@ -122,21 +272,37 @@ private:
 	static bool registered;
 
 	static FCriticalSection Mutex;
-	static TMap<TWeakObjectPtr<UFGFactoryConnectionComponent>, int8> FactoryGrabsRunning;
+
+	/**
+	 * Subscribes the circuit tick hook if not already done.
+	 */
+	static void SubscribeHooks();
+
+	/**
+	 * Returns the statistics cache of the given circuit, nullptr if the circuit has no cache.
+	 */
+	static FFINPowerCircuitStatsCache* FindStatsCache(UFGPowerCircuit* circuit);
+
+	/**
+	 * Creates a snapshot of the current statistics of the given circuit.
+	 */
+	static FFINPowerCircuitSnapshot CreateSnapshot(UFGPowerCircuit* circuit);
 
 	static void TickCircuitHook_Decl(UFGPowerCircuit*, float);
 	static void TickCircuitHook(CallScope<void(*)(UFGPowerCircuit*, float)>& scope, UFGPowerCircuit* circuit, float dt) {
 		bool oldFused = circuit->IsFuseTriggered();
 		scope(circuit, dt);
 		bool fused = circuit->IsFuseTriggered();
+		FFINPowerCircuitStatsCache* cache = FindStatsCache(circuit);
+		if (cache) cache->Publish(CreateSnapshot(circuit));
 		if (oldFused != fused) try {
+			// emit outside of the lock, the hook subsystem registers hooks while holding its own lock
+			UObject* obj = nullptr;
 			Mutex.Lock();
 			FWeakObjectPtr* sender = Senders.Find(circuit);
-			if (sender) {
-				UObject* obj = sender->Get();
-				AFINHookSubsystem::GetHookSubsystem(obj)->EmitSignal(obj, FFINSmartSignal("PowerFuseChanged"));
-			}
+			if (sender) obj = sender->Get();
 			Mutex.Unlock();
+			if (obj) AFINHookSubsystem::GetHookSubsystem(obj)->EmitSignal(obj, FFINSmartSignal("PowerFuseChanged"));
 		} catch (...) {}
 	}
 			
@@ -144,12 +310,7 @@ public:
 	void Register(UObject* sender) override {
 		Mutex.Lock();
     	Senders.Add(Sender = sender);
-
-		if (!registered) {
-			registered = true;
-			
-			SUBSCRIBE_METHOD_MANUAL("?TickCircuit@UFGPowerCircuit@@MEAAXM@Z", TickCircuitHook_Decl, &TickCircuitHook);
-		}
+		SubscribeHooks();
 		Mutex.Unlock();
     }
 		
@@ -158,6 +319,16 @@ public:
     	Senders.Remove(Sender);
 		Mutex.Unlock();
     }
+
+	/**
+	 * Returns the statistics of the given circuit published with the last circuit tick.
+	 * The first request of the statistics of a circuit creates the snapshot directly,
+	 * from then on it gets published with every circuit tick.
+	 *
+	 * @param[in]	circuit		the power circuit you want to get the statistics of
+	 * @return	the statistics snapshot of the circuit
+	 */
+	static FFINPowerCircuitSnapshot GetStats(UFGPowerCircuit* circuit);
 };
 
 USTRUCT()
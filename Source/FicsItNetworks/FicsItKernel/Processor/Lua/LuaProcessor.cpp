@@ -74,6 +74,75 @@ namespace FicsItKernel {
 			}
 		}
 
+		void LuaGCScheduler::reset(lua_State* L, const LuaAllocator& allocator) {
+			lua_gc(L, LUA_GCSTOP, 0);
+			lastUsage = allocator.getUsage();
+		}
+
+		void LuaGCScheduler::tick(lua_State* L, const LuaAllocator& allocator, std::int64_t budget) {
+			std::int64_t usage = allocator.getUsage();
+			if (budget > 0 && usage >= budget / 100 * fullCollectThreshold) {
+				// memory limit is about to be breached -> try to free as much as possible
+				lua_gc(L, LUA_GCCOLLECT, 0);
+			} else {
+				std::int64_t debt = usage - lastUsage;
+				if (debt > 0) {
+					std::int64_t stepKB = debt / 1024 * stepMultiplier / 100;
+					if (stepKB < minStepKB) stepKB = minStepKB;
+					if (stepKB > maxStepKB) stepKB = maxStepKB;
+					lua_gc(L, LUA_GCSTEP, static_cast<int>(stepKB));
+				}
+			}
+			lastUsage = allocator.getUsage();
+		}
+
+		LuaParameterStack::~LuaParameterStack() {
+			for (Block& block : blocks) FMemory::Free(block.Data);
+		}
+
+		void* LuaParameterStack::push(std::size_t size, std::size_t alignment) {
+			if (alignment < 1) alignment = 1;
+			while (current < blocks.size()) {
+				Block& block = blocks[current];
+				std::size_t offset = Align(block.Top, alignment);
+				if (offset + size <= block.Size) {
+					block.Top = offset + size;
+					return block.Data + offset;
+				}
+				if (block.Top == 0) {
+					// block is too small for the frame -> replace it with a bigger one
+					FMemory::Free(block.Data);
+					block.Size = Align(size, BlockSize);
+					block.Data = static_cast<char*>(FMemory::Malloc(block.Size, 16));
+					continue;
+				}
+				++current;
+			}
+			std::size_t blockSize = size > BlockSize ? Align(size, BlockSize) : BlockSize;
+			blocks.push_back(Block{static_cast<char*>(FMemory::Malloc(blockSize, 16)), blockSize, 0});
+			current = blocks.size() - 1;
+			return push(size, alignment);
+		}
+
+		void LuaParameterStack::pop(void* frame) {
+			while (current < blocks.size()) {
+				Block& block = blocks[current];
+				char* ptr = static_cast<char*>(frame);
+				if (ptr >= block.Data && ptr < block.Data + block.Size) {
+					block.Top = ptr - block.Data;
+					return;
+				}
+				block.Top = 0;
+				if (current == 0) return;
+				--current;
+			}
+		}
+
+		void LuaParameterStack::clear() {
+			for (Block& block : blocks) block.Top = 0;
+			current = 0;
+		}
+
 		LuaProcessor* LuaProcessor::luaGetProcessor(lua_State* L) {
 			lua_getfield(L, LUA_REGISTRYINDEX, "LuaProcessorPtr");
 			LuaProcessor* p = *(LuaProcessor**) luaL_checkudata(L, -1, "LuaProcessor");
@@ -93,9 +162,21 @@ namespace FicsItKernel {
 		void LuaProcessor::tick(float delta) {
 			if (!luaState || !luaThread) return;
 
+			// take the instructions of this tick from the global budget, skip the tick if it is exhausted
+			InstructionBudget* budget = kernel->getInstructionBudget();
+			tickSlice = budget ? budget->acquire(speed) : speed;
+			if (tickSlice < 1) {
+				if (budget) budget->release(speed, tickSlice, 0);
+				return;
+			}
+
 			// reset out of time
 			endOfTick = false;
-			lua_sethook(luaThread, luaHook, LUA_MASKCOUNT, speed);
+			tickInstructions = 0;
+			tickLimit = tickSlice;
+			hookStep = static_cast<int>(FMath::Max(tickSlice / 8, FMath::Min<std::int64_t>(tickSlice, 1000)));
+			parameterStack.clear();
+			lua_sethook(luaThread, luaHook, LUA_MASKCOUNT, hookStep);
 			
 			int status = 0;
 			if (pullState != 0) {
@@ -109,28 +190,32 @@ namespace FicsItKernel {
 						status = LUA_ERRRUN;
 					} else {
 						// signal poped -> resume yield with signal as parameters (passing signals parameters back to pull yield)
-						status = lua_resume(luaThread, nullptr, sigArgs);
+						status = resumeThread(sigArgs);
 					}
 				} else if (pullState == 2 || timeout > (static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - pullStart).count()) / 1000.0)) {
-					// no signal available & not timeout reached -> skip tick
+					// no signal available & not timeout reached -> skip tick and donate the instructions
+					if (budget) budget->release(speed, tickSlice, 0);
 					return;
 				} else {
 					// no signal available & timout reached -> resume yield with  no parameters
 					pullState = 0;
-					status = lua_resume(luaThread, nullptr, 0);
+					status = resumeThread(0);
 				}
 			} else {
 				// resume runtime normally
-				status = lua_resume(luaThread, nullptr, 0);
+				status = resumeThread(0);
 			}
 			
 			if (status == LUA_YIELD) {
 				// system yielded and waits for next tick
-				lua_gc(luaState, LUA_GCCOLLECT, 0);
+				gcScheduler.tick(luaState, allocator, getMemoryBudget());
 				kernel->recalculateResources(KernelSystem::PROCESSOR);
 			} else if (status == LUA_OK) {
 				// runtime finished execution -> stop system normally
 				kernel->stop();
+			} else if (status == LUA_ERRMEM) {
+				// runtime ran out of memory -> crash system without traceback, it would need memory we don't have
+				kernel->crash(KernelCrash("out of memory"));
 			} else {
 				// runtimed crashed -> crash system with runtime error message
 				
@@ -138,10 +223,30 @@ namespace FicsItKernel {
 				kernel->crash({ std::string(lua_tostring(luaThread, -1)) });
 			}
 
+			if (budget) budget->release(speed, tickSlice, tickInstructions);
+
 			// clear some data
 			clearFileStreams();
 		}
 
+		int LuaProcessor::resumeThread(int args) {
+			allocator.setBudget(getMemoryBudget());
+			int status = lua_resume(luaThread, nullptr, args);
+			// allocations outside of the protected thread execution must not fail
+			allocator.setBudget(LuaAllocator::Unlimited);
+			return status;
+		}
+
+		std::int64_t LuaProcessor::getMemoryBudget() {
+			std::int64_t otherUsage = kernel->getMemoryUsage() - memoryUsage;
+			return kernel->getCapacity() - otherUsage;
+		}
+
+		int luaPanic(lua_State* L) {
+			SML::Logging::error("Lua panic! '", lua_tostring(L, -1), "'");
+			return 0;
+		}
+
 		size_t luaLen(lua_State* L, int idx) {
 			size_t len = 0;
 			idx = lua_absindex(L, idx);
@@ -165,6 +270,10 @@ namespace FicsItKernel {
 			return fileStreams;
 		}
 
+		LuaParameterStack& LuaProcessor::getParameterStack() {
+			return parameterStack;
+		}
+
 		void LuaProcessor::reset() {
 			// can't reset running system state
 			if (getKernel()->getState() != RUNNING) return;
@@ -178,9 +287,11 @@ namespace FicsItKernel {
 			if (luaState) {
 				lua_close(luaState);
 			}
+			allocator.clear();
 
-			// create new lua state
-			luaState = luaL_newstate();
+			// create new lua state using the kernels own allocator
+			luaState = lua_newstate(&LuaAllocator::luaAlloc, &allocator);
+			lua_atpanic(luaState, &luaPanic);
 
 			// setup library and perm tables for persistency
 			lua_newtable(luaState); // perm
@@ -217,13 +328,14 @@ namespace FicsItKernel {
 			}
 			std::string code = std::string(TCHAR_TO_UTF8(*eeprom->Code), eeprom->Code.Len());
 			luaL_loadbuffer(luaThread, code.c_str(), code.size(), "=EEPROM");
-			
-			// lua_gc(luaState, LUA_GCSETPAUSE, 100);
-			// TODO: Check if we actually want to use this or the manual gc call
+
+			// garbage collection gets only done by the scheduler at the end of each tick
+			gcScheduler.reset(luaState, allocator);
 		}
 
 		std::int64_t LuaProcessor::getMemoryUsage(bool recalc) {
-			return lua_gc(luaState, LUA_GCCOUNT, 0)* 1000;
+			memoryUsage = allocator.getUsage();
+			return memoryUsage;
 		}
 
 		static constexpr uint32 Base64GetEncodedDataSize(uint32 NumBytes) {
@@ -581,7 +693,7 @@ namespace FicsItKernel {
 			TFINDynamicStruct<FFINSignal> signal = net->popSignal(sender);
 			if (!signal.GetData()) return 0;
 			int props = 2;
-			lua_pushstring(L, TCHAR_TO_UTF8(*signal->GetName()));
+			luaPushName(L, signal->GetNameId());
 			newInstance(L, sender);
 			LuaValueReader reader(L);
 			props += signal.Get<FFINSignal>() >> reader;
@@ -590,11 +702,20 @@ namespace FicsItKernel {
 
 		void LuaProcessor::luaHook(lua_State* L, lua_Debug* ar) {
 			LuaProcessor* p = LuaProcessor::luaGetProcessor(L);
+			p->tickInstructions += p->hookStep;
+			if (p->tickInstructions < p->tickLimit) return;
 			if (p->endOfTick) {
 				luaL_error(L, "out of time");
 			} else {
 				p->endOfTick = true;
-				lua_sethook(p->luaThread, luaHook, LUA_MASKCOUNT, p->speed / 2);
+				// a throttled tick gets preempted if possible, so the script just continues in the next tick
+				if (p->tickSlice < p->speed && lua_isyieldable(L)) {
+					lua_yield(L, 0);
+					return;
+				}
+				// a throttled tick which can't be preempted gets at least the grace period of an unthrottled tick,
+				// so code that can't yield doesn't fail just because the budget was short, the overrun gets counted against the budget
+				p->tickLimit = FMath::Max(p->tickInstructions, p->speed) + p->speed / 2;
 			}
 		}
 
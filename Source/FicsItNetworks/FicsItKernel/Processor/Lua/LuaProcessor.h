@@ -2,8 +2,10 @@
 
 #include <chrono>
 #include <set>
+#include <vector>
 
 #include "FicsItKernel/Processor/Processor.h"
+#include "LuaAllocator.h"
 #include "LuaFileSystemAPI.h"
 
 class AFINStateEEPROMLua;
@@ -40,6 +42,100 @@ namespace FicsItKernel {
 			virtual void onNodeRemoved(FileSystem::Path path, FileSystem::NodeType type) override;
 		};
 
+		/**
+		 * Schedules the garbage collection of a lua state.
+		 * Instead of doing a full collection every tick, it does bounded incremental
+		 * collection steps sized by the memory allocated since the last step (allocation debt).
+		 * A full collection is only forced if the memory usage is about to breach the given budget.
+		 */
+		class LuaGCScheduler {
+		private:
+			std::int64_t lastUsage = 0;
+
+		public:
+			/**
+			 * The minimum and maximum amount of KB a single incremental step should collect.
+			 */
+			int minStepKB = 4;
+			int maxStepKB = 1024;
+
+			/**
+			 * The factor (in percent) applied to the allocation debt to get the step size.
+			 * Values above 100 make the collector catch up faster than the script allocates.
+			 */
+			int stepMultiplier = 200;
+
+			/**
+			 * The fraction (in percent) of the memory budget at which a full collection gets forced.
+			 */
+			int fullCollectThreshold = 90;
+
+			/**
+			 * Stops the automatic collector of the given lua state, so collection only happens
+			 * in the scheduled steps, and resets the allocation debt.
+			 *
+			 * @param[in]	L			the lua state the scheduler should manage
+			 * @param[in]	allocator	the allocator used by the lua state
+			 */
+			void reset(lua_State* L, const LuaAllocator& allocator);
+
+			/**
+			 * Does the scheduled garbage collection work for this tick.
+			 *
+			 * @param[in]	L			the lua state you want to collect
+			 * @param[in]	allocator	the allocator used by the lua state
+			 * @param[in]	budget		the amount of bytes the lua state is allowed to use
+			 */
+			void tick(lua_State* L, const LuaAllocator& allocator, std::int64_t budget);
+		};
+
+		/**
+		 * Stack allocator for the parameter structs of reflected function calls.
+		 * Memory is kept in blocks which get reused, so calls don't have to allocate on the heap.
+		 * Frames have to be popped in reverse order of pushing.
+		 */
+		class LuaParameterStack {
+		private:
+			static constexpr std::size_t BlockSize = 16 * 1024;
+
+			struct Block {
+				char* Data;
+				std::size_t Size;
+				std::size_t Top;
+			};
+
+			std::vector<Block> blocks;
+			std::size_t current = 0;
+
+		public:
+			LuaParameterStack() = default;
+			LuaParameterStack(const LuaParameterStack&) = delete;
+			LuaParameterStack& operator=(const LuaParameterStack&) = delete;
+			~LuaParameterStack();
+
+			/**
+			 * Pushes a new frame onto the stack.
+			 *
+			 * @param[in]	size		the size of the frame in bytes
+			 * @param[in]	alignment	the alignment the frame needs
+			 * @return	pointer to the memory of the frame
+			 */
+			void* push(std::size_t size, std::size_t alignment);
+
+			/**
+			 * Pops the given frame and all frames pushed after it from the stack.
+			 *
+			 * @param[in]	frame	the frame you want to pop
+			 */
+			void pop(void* frame);
+
+			/**
+			 * Pops all frames from the stack.
+			 * Used to recover frames left over by calls aborted by a lua error.
+			 */
+			void clear();
+		};
+
 		class LuaProcessor : public Processor {
 			friend int luaPull(lua_State* L);
 
@@ -53,11 +149,45 @@ namespace FicsItKernel {
 			int luaThreadIndex = 0;
 			bool endOfTick = false;
 
+			/**
+			 * The instructions the current tick is allowed to execute, taken from the instruction budget of the kernel.
+			 */
+			std::int64_t tickSlice = 0;
+
+			/**
+			 * The instructions executed in the current tick, counted in steps of the hook.
+			 */
+			std::int64_t tickInstructions = 0;
+
+			/**
+			 * The instructions after which the current tick runs out of time.
+			 */
+			std::int64_t tickLimit = 0;
+			int hookStep = 0;
+
 			int pullState = 0; // 0 = not pulling, 1 = pulling with timeout, 2 = pull indefinetly
 			double timeout = 0.0;
 			std::chrono::time_point<std::chrono::high_resolution_clock> pullStart;
 			std::set<LuaFile> fileStreams;
 			FileSystem::SRef<LuaFileSystemListener> fileSystemListener;
+			LuaAllocator allocator;
+			LuaGCScheduler gcScheduler;
+			LuaParameterStack parameterStack;
+			std::int64_t memoryUsage = 0;
+
+			/**
+			 * Resumes the lua thread with the allocations limited to the memory
+			 * the kernel has left for the processor.
+			 *
+			 * @param[in]	args	the count of arguments passed to the thread
+			 * @return	the status returned by lua_resume
+			 */
+			int resumeThread(int args);
+
+			/**
+			 * Returns the amount of bytes the lua state is allowed to use.
+			 */
+			std::int64_t getMemoryBudget();
 			
 		public:
 			static LuaProcessor* luaGetProcessor(lua_State* L);
@@ -104,6 +234,11 @@ namespace FicsItKernel {
 			void clearFileStreams();
 			std::set<LuaFile> getFileStreams() const;
 
+			/**
+			 * Returns the stack used for the parameters of reflected function calls.
+			 */
+			LuaParameterStack& getParameterStack();
+
 			static void luaHook(lua_State* L, lua_Debug* ar);
 
 			/**
@@ -43,12 +43,16 @@ namespace FicsItKernel {
 		}
 
 		FString FFINLuaStructRegistry::GetName(UScriptStruct* Type) {
-			FString* Name = RegisteredStructTypeNames.Find(Type);
+			return GetNameId(Type).ToString();
+		}
+
+		FFINName FFINLuaStructRegistry::GetNameId(UScriptStruct* Type) {
+			FFINName* Name = RegisteredStructTypeNames.Find(Type);
 			if (Name) return *Name;
-			return TEXT("");
+			return FFINName();
 		}
 		
-		UScriptStruct* FFINLuaStructRegistry::GetType(FString Name) {
+		UScriptStruct* FFINLuaStructRegistry::GetType(FFINName Name) {
 			UScriptStruct** Type = RegisteredNamesOfStructTypes.Find(Name);
 			if (Type) return *Type;
 			return nullptr;
@@ -77,17 +81,28 @@ namespace FicsItKernel {
 			}
 		}
 
+		bool luaGetStructTypeName(lua_State* L, int i, FFINName& Name) {
+			if (luaL_getmetafield(L, i, "__name") == LUA_TNIL) return false;
+			size_t Len;
+			const char* Str = lua_tolstring(L, -1, &Len);
+			const bool bFound = Str && FFINName::FindUTF8(Str, Len, Name);
+			lua_pop(L, 1);
+			return bFound;
+		}
+
 		void luaGetStruct(lua_State* L, int i, FFINDynamicStructHolder& Struct) {
 			FFINLuaStructRegistry::StructGetterFunc Getter;
-			FString TypeName = FFINLuaStructRegistry::Get().GetName(Struct.GetStruct());
+			FFINName TypeName = FFINLuaStructRegistry::Get().GetNameId(Struct.GetStruct());
 			i = lua_absindex(L, i);
-			if (FString(luaL_typename(L, i)) != TypeName) luaL_argerror(L, i, (std::string("'") + TCHAR_TO_UTF8(*TypeName) + "'" + " expected, got '" + luaL_typename(L, i) + "'").c_str());
+			FFINName ValueTypeName;
+			if (!luaGetStructTypeName(L, i, ValueTypeName) || ValueTypeName != TypeName) luaL_argerror(L, i, (std::string("'") + TypeName.ToUTF8() + "'" + " expected, got '" + luaL_typename(L, i) + "'").c_str());
 			if (!FFINLuaStructRegistry::Get().FindStructType(Struct.GetStruct(), nullptr, &Getter)) return;
 			Getter(L, i, Struct);
 		}
 
 		FFINDynamicStructHolder luaGetStruct(lua_State* L, int i) {
-			FString TypeName = luaL_typename(L, i);
+			FFINName TypeName;
+			if (!luaGetStructTypeName(L, i, TypeName)) return FFINDynamicStructHolder();
 			UScriptStruct* Type = FFINLuaStructRegistry::Get().GetType(TypeName);
 			if (!Type) return FFINDynamicStructHolder();
 			FFINDynamicStructHolder Struct(Type);
@@ -139,7 +154,7 @@ namespace FicsItKernel {
             //lua_setfield(L, -2, "state");
             luaL_setmetatable(L, "Item");
 		}, [](lua_State* L, int i, FFINDynamicStructHolder& Struct) {
-			FInventoryItem& Item = Struct.Get<FInventoryItem>();
+			FInventoryItem& Item = Struct.GetMutable<FInventoryItem>();
 			lua_getfield(L, i, "type");
 			Item.ItemClass = getClassInstance<UFGItemDescriptor>(L, -1);
 			lua_pop(L, 1);
@@ -180,7 +195,7 @@ namespace FicsItKernel {
             lua_setfield(L, -2, "item");
             luaL_setmetatable(L, "ItemAmount");
         }, [](lua_State* L, int i, FFINDynamicStructHolder& Struct) {
-            FItemAmount& Amount = Struct.Get<FItemAmount>();
+            FItemAmount& Amount = Struct.GetMutable<FItemAmount>();
             lua_getfield(L, i, "item");
             Amount.ItemClass = getClassInstance<UFGItemDescriptor>(L, -1);
         	lua_getfield(L, i, "count");
@@ -223,7 +238,7 @@ namespace FicsItKernel {
             lua_setfield(L, -2, "item");
             luaL_setmetatable(L, "ItemStack");
         }, [](lua_State* L, int i, FFINDynamicStructHolder& Struct) {
-            FInventoryStack& Stack = Struct.Get<FInventoryStack>();
+            FInventoryStack& Stack = Struct.GetMutable<FInventoryStack>();
             lua_getfield(L, i, "item");
             Stack.Item = luaGetStruct<FInventoryItem>(L, -1);
             lua_getfield(L, i, "count");
@@ -26,8 +26,8 @@ namespace FicsItKernel {
 			
 		private:
 			TMap<UScriptStruct*, FFINLuaStructRegisterData> RegisteredStructTypes;
-			TMap<UScriptStruct*, FString> RegisteredStructTypeNames;
-			TMap<FString, UScriptStruct*> RegisteredNamesOfStructTypes;
+			TMap<UScriptStruct*, FFINName> RegisteredStructTypeNames;
+			TMap<FFINName, UScriptStruct*> RegisteredNamesOfStructTypes;
 
 			FFINLuaStructRegistry() = default;
 
@@ -51,11 +51,17 @@ namespace FicsItKernel {
 			 */
 			FString GetName(UScriptStruct* Type);
 
+			/**
+			 * Returns the interned name of the given type.
+			 * Empty name if not found.
+			 */
+			FFINName GetNameId(UScriptStruct* Type);
+
 			/**
 			 * Returns the struct type of the given name.
 			 * Nullptr if not found.
 			 */
-			UScriptStruct* GetType(FString Name);
+			UScriptStruct* GetType(FFINName Name);
 			
 			/**
 			 * Trys to find the Constructor and Getter for the given struct type.
@@ -76,6 +82,15 @@ namespace FicsItKernel {
 		 */
 		void luaStruct(lua_State* L, const FINStruct& Struct);
 
+		/**
+		 * Trys to get the name of the struct type of the lua value at the given index.
+		 * The name is the name of the metatable of the value.
+		 *
+		 * @param[out]	Name	gets set to the name of the struct type
+		 * @return	true if the value has a named metatable
+		 */
+		bool luaGetStructTypeName(lua_State* L, int i, FFINName& Name);
+
 		/**
 		 * Trys to convert the lua value at the given index
 		 * back to a struct of the type already set in the holder.
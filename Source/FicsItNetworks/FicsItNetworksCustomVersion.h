@@ -13,6 +13,12 @@ enum EFINCustomVersion {
     // Signal Storage / Trace / "Parameter List" overhaul
     FINSignalStorage,
 
+    // Signal filters of event.listen
+    FINSignalFilters,
+
+    // Signal coalescing option of hook listeners
+    FINHookCoalescing,
+
     // -----<new versions can be added above this line>-------------------------------------------------
     FINVersionPlusOne,
     FINLatestVersion = FINVersionPlusOne - 1
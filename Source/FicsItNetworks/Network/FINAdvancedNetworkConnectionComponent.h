@@ -8,6 +8,7 @@
 #include "FINAdvancedNetworkConnectionComponent.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFINHandleSignal, const FFINDynamicStructHolder&, Signal, const FFINNetworkTrace&, Sender);
+DECLARE_DELEGATE_RetVal_TwoParams(bool, FFINHandleSignalNative, const FFINDynamicStructHolder&, const FFINNetworkTrace&);
 
 /**
  * This network connectionc component allows for cabled connections and additionally
@@ -65,6 +66,12 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "Network|Connector")
 	FFINHandleSignal OnNetworkSignal;
 
+	/**
+	 * This event gets called if a signal ocures, before OnNetworkSignal.
+	 * Returns if the signal got accepted, so the sender can know if the signal got dropped.
+	 */
+	FFINHandleSignalNative OnNetworkSignalNative;
+
 	UFINAdvancedNetworkConnectionComponent();
 	~UFINAdvancedNetworkConnectionComponent();
 	
@@ -78,7 +85,7 @@ public:
 	// End IFGSaveInterface
 
 	// Begin IFINNetworkCircuitNode
-	virtual void NotifyNetworkUpdate_Implementation(int Type, const TSet<UObject*>& Nodes) override;
+	virtual void NotifyNetworkUpdate_Implementation(int Type, const TSet<FGuid>& Components) override;
 	// End IFINNetworkCircuitNode
 
 	// Begin IFINNetworkComponent
@@ -98,11 +105,17 @@ public:
 	// End IFINSignalSender
 
 	// Begin IFINSignalListener
-	virtual void HandleSignal(const TFINDynamicStruct<FFINSignal>& Signal, const FFINNetworkTrace& Sender) override;
+	virtual bool HandleSignal(const TFINDynamicStruct<FFINSignal>& Signal, const FFINNetworkTrace& Sender) override;
 	// End IFINSignalListener
 
+	/**
+	 * The max amount of component ids a single NetworkUpdate signal carries.
+	 */
+	static constexpr int32 MaxNetworkUpdateComponents = 128;
+
 	/**
 	 * This network signals gets emit when a network change occurs.
+	 * The actual signal carries the ids of all components changed in the frame as additional parameters.
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Network|Signals")
 	void netSig_NetworkUpdate(int changeType, const FString& changedComponent);
@@ -1,6 +1,7 @@
 #include "FINAdvancedNetworkConnectionComponent.h"
 
 #include "FINNetworkCircuit.h"
+#include "Signals/FINSmartSignal.h"
 
 UFINAdvancedNetworkConnectionComponent::UFINAdvancedNetworkConnectionComponent() {}
 
@@ -12,6 +13,7 @@ void UFINAdvancedNetworkConnectionComponent::BeginPlay() {
 	if (!bIdCreated) {
 		ID = FGuid::NewGuid();
 		bIdCreated = true;
+		if (Circuit) Circuit->UpdateComponent(this);
 	}
 
 	// setup circuit
@@ -29,13 +31,21 @@ bool UFINAdvancedNetworkConnectionComponent::ShouldSave_Implementation() const {
 	return true;
 }
 
-void UFINAdvancedNetworkConnectionComponent::NotifyNetworkUpdate_Implementation(int Type, const TSet<UObject*>& Nodes) {
-	if (Listeners.Num() < 1) return;
-	for (UObject* Node : Nodes) {
-		if (Node->GetClass()->ImplementsInterface(UFINNetworkComponent::StaticClass())) {
-			netSig_NetworkUpdate(Type, IFINNetworkComponent::Execute_GetID(Node).ToString());
+void UFINAdvancedNetworkConnectionComponent::NotifyNetworkUpdate_Implementation(int Type, const TSet<FGuid>& Components) {
+	if (Listeners.Num() < 1 || Components.Num() < 1) return;
+
+	// one signal carries the ids of all changed components, only huge changes get split up to keep the lua stack small
+	static const FFINName SignalName(TEXT("NetworkUpdate"));
+	TArray<FFINAnyNetworkValue> Args;
+	Args.Add(FFINAnyNetworkValue(static_cast<FINInt>(Type)));
+	for (const FGuid& Component : Components) {
+		Args.Add(FFINAnyNetworkValue(Component.ToString()));
+		if (Args.Num() > MaxNetworkUpdateComponents) {
+			UFINSignalUtility::BroadcastSignal(this, FFINSmartSignal(SignalName, Args));
+			Args.SetNum(1);
 		}
 	}
+	if (Args.Num() > 1) UFINSignalUtility::BroadcastSignal(this, FFINSmartSignal(SignalName, Args));
 }
 
 FGuid UFINAdvancedNetworkConnectionComponent::GetID_Implementation() const {
@@ -48,6 +58,7 @@ FString UFINAdvancedNetworkConnectionComponent::GetNick_Implementation() const {
 
 void UFINAdvancedNetworkConnectionComponent::SetNick_Implementation(const FString& Nick) {
 	this->Nick = Nick;
+	if (Circuit) Circuit->UpdateComponent(this);
 }
 
 bool UFINAdvancedNetworkConnectionComponent::HasNick_Implementation(const FString& Nick) {
@@ -79,8 +90,15 @@ UObject* UFINAdvancedNetworkConnectionComponent::GetSignalSenderOverride_Impleme
 	return this;
 }
 
-void UFINAdvancedNetworkConnectionComponent::HandleSignal(const TFINDynamicStruct<FFINSignal>& Signal, const FFINNetworkTrace& Sender) {
-	OnNetworkSignal.Broadcast(Signal, Sender);
+bool UFINAdvancedNetworkConnectionComponent::HandleSignal(const TFINDynamicStruct<FFINSignal>& Signal, const FFINNetworkTrace& Sender) {
+	bool bAccepted = false;
+	if (OnNetworkSignalNative.IsBound()) bAccepted = OnNetworkSignalNative.Execute(Signal, Sender);
+	// blueprint handlers can't tell if they dropped the signal, so they count as accepting it
+	if (OnNetworkSignal.IsBound()) {
+		OnNetworkSignal.Broadcast(Signal, Sender);
+		bAccepted = true;
+	}
+	return bAccepted;
 }
 
 void UFINAdvancedNetworkConnectionComponent::netSig_NetworkUpdate_Implementation(int type, const FString& id) {}
@@ -23,22 +23,22 @@ FFINAnyNetworkValue::FFINAnyNetworkValue(FINClass e) {
 }
 
 FFINAnyNetworkValue::FFINAnyNetworkValue(const FINStr& e) {
-	Data.STRING = new FINStr(e);
+	new (&Data.STRING) TSharedPtr<const FINStr, ESPMode::ThreadSafe>(MakeShared<FINStr, ESPMode::ThreadSafe>(e));
 	Type = FIN_STR;
 }
 
 FFINAnyNetworkValue::FFINAnyNetworkValue(const FINObj& e) {
-	Data.OBJECT = new FINObj(e);
+	new (&Data.OBJECT) FINObj(e);
 	Type = FIN_OBJ;
 }
 
 FFINAnyNetworkValue::FFINAnyNetworkValue(const FINTrace& e) {
-	Data.TRACE = new FINTrace(e);
+	new (&Data.TRACE) FINTrace(e);
 	Type = FIN_TRACE;
 }
 
 FFINAnyNetworkValue::FFINAnyNetworkValue(const FINStruct& e) {
-	Data.STRUCT = new FINStruct(e);
+	new (&Data.STRUCT) TSharedPtr<const FINStruct, ESPMode::ThreadSafe>(MakeShared<FINStruct, ESPMode::ThreadSafe>(e));
 	Type = FIN_STRUCT;
 }
 
@@ -47,82 +47,126 @@ FFINAnyNetworkValue::FFINAnyNetworkValue(const FFINAnyNetworkValue& other) {
 }
 
 FFINAnyNetworkValue& FFINAnyNetworkValue::operator=(const FFINAnyNetworkValue& other) {
-	Type = other.Type;
-	switch (Type) {
+	if (this == &other) return *this;
+	Reset();
+	switch (other.Type) {
 	case FIN_STR:
-		Data.STRING = new FINStr(*other.Data.STRING);
+		new (&Data.STRING) TSharedPtr<const FINStr, ESPMode::ThreadSafe>(other.Data.STRING);
 		break;
 	case FIN_OBJ:
-		Data.OBJECT = new FINObj(*other.Data.OBJECT);
+		new (&Data.OBJECT) FINObj(other.Data.OBJECT);
+		break;
 	case FIN_TRACE:
-		Data.TRACE = new FINTrace(*other.Data.TRACE);
+		new (&Data.TRACE) FINTrace(other.Data.TRACE);
 		break;
 	case FIN_STRUCT:
-		Data.STRUCT = new FINStruct(*other.Data.STRUCT);
+		new (&Data.STRUCT) TSharedPtr<const FINStruct, ESPMode::ThreadSafe>(other.Data.STRUCT);
+		break;
+	case FIN_INT:
+		Data.INT = other.Data.INT;
+		break;
+	case FIN_FLOAT:
+		Data.FLOAT = other.Data.FLOAT;
+		break;
+	case FIN_BOOL:
+		Data.BOOL = other.Data.BOOL;
+		break;
+	case FIN_CLASS:
+		Data.CLASS = other.Data.CLASS;
 		break;
 	default:
-		Data = other.Data;
 		break;
 	}
+	Type = other.Type;
 	return *this;
 }
 
+bool FFINAnyNetworkValue::operator==(const FFINAnyNetworkValue& Other) const {
+	if (Type != Other.Type) return false;
+	switch (Type) {
+	case FIN_NIL:
+		return true;
+	case FIN_BOOL:
+		return Data.BOOL == Other.Data.BOOL;
+	case FIN_INT:
+		return Data.INT == Other.Data.INT;
+	case FIN_FLOAT:
+		return Data.FLOAT == Other.Data.FLOAT;
+	case FIN_CLASS:
+		return Data.CLASS == Other.Data.CLASS;
+	case FIN_STR:
+		return Data.STRING == Other.Data.STRING || *Data.STRING == *Other.Data.STRING;
+	case FIN_OBJ:
+		return Data.OBJECT == Other.Data.OBJECT;
+	case FIN_TRACE:
+		return Data.TRACE.IsEqualObj(Other.Data.TRACE);
+	case FIN_STRUCT:
+		if (Data.STRUCT == Other.Data.STRUCT) return true;
+		if (Data.STRUCT->GetStruct() != Other.Data.STRUCT->GetStruct()) return false;
+		if (!Data.STRUCT->GetData() || !Other.Data.STRUCT->GetData()) return Data.STRUCT->GetData() == Other.Data.STRUCT->GetData();
+		return Data.STRUCT->GetStruct()->CompareScriptStruct(Data.STRUCT->GetData(), Other.Data.STRUCT->GetData(), PPF_None);
+	default:
+		return false;
+	}
+}
+
 FFINAnyNetworkValue::~FFINAnyNetworkValue() {
+	Reset();
+}
+
+void FFINAnyNetworkValue::Reset() {
 	switch (Type) {
 	case FIN_STR:
-		delete Data.STRING;
+		Data.STRING.~TSharedPtr();
 		break;
 	case FIN_OBJ:
-		delete Data.OBJECT;
+		Data.OBJECT.~FINObj();
 		break;
 	case FIN_TRACE:
-		delete Data.TRACE;
+		Data.TRACE.~FINTrace();
 		break;
 	case FIN_STRUCT:
-		delete Data.STRUCT;
+		Data.STRUCT.~TSharedPtr();
 		break;
 	default:
 		break;
 	}
+	Type = FIN_NIL;
+	Data.INT = 0;
 }
 
 bool FFINAnyNetworkValue::Serialize(FArchive& Ar) {
 	if (Ar.IsLoading()) {
-		switch (Type) {
-		case FIN_STR:
-			delete Data.STRING;
-			break;
-		case FIN_OBJ:
-			delete Data.OBJECT;
-			break;
-		case FIN_TRACE:
-			delete Data.TRACE;
-			break;
-		case FIN_STRUCT:
-			delete Data.STRUCT;
-			break;
-		default:
-			break;
-		}
-	}
-	Ar << Type;
-	if (Ar.IsLoading()) {
-		switch (Type) {
-		case FIN_STR:
-			Data.STRING = new FINStr();
+		Reset();
+		TEnumAsByte<EFINNetworkValueType> NewType;
+		Ar << NewType;
+		switch (NewType) {
+		case FIN_STR: {
+			FINStr Str;
+			Ar << Str;
+			*this = FFINAnyNetworkValue(Str);
 			break;
-		case FIN_OBJ:
-			Data.OBJECT = new FINObj();
+		} case FIN_OBJ: {
+			FINObj Obj;
+			Ar << Obj;
+			*this = FFINAnyNetworkValue(Obj);
 			break;
-		case FIN_TRACE:
-			Data.TRACE = new FINTrace();
+		} case FIN_TRACE: {
+			FINTrace Trace;
+			Ar << Trace;
+			*this = FFINAnyNetworkValue(Trace);
 			break;
-		case FIN_STRUCT:
-			Data.STRUCT = new FINStruct();
+		} case FIN_STRUCT: {
+			FINStruct Struct;
+			Ar << Struct;
+			*this = FFINAnyNetworkValue(Struct);
 			break;
-		default:
+		} default:
+			Type = NewType;
 			break;
 		}
+	} else {
+		Ar << Type;
 	}
 
 	switch (Type) {
@@ -136,19 +180,19 @@ bool FFINAnyNetworkValue::Serialize(FArchive& Ar) {
 		Ar << Data.BOOL;
 		break;
 	case FIN_STR:
-		Ar << *Data.STRING;
+		if (Ar.IsSaving()) Ar << const_cast<FINStr&>(*Data.STRING);
 		break;
 	case FIN_OBJ:
-		Ar << *Data.OBJECT;
+		if (Ar.IsSaving()) Ar << Data.OBJECT;
 		break;
 	case FIN_CLASS:
 		Ar << Data.CLASS;
 		break;
 	case FIN_TRACE:
-		Ar << *Data.TRACE;
+		if (Ar.IsSaving()) Ar << Data.TRACE;
 		break;
 	case FIN_STRUCT:
-		Ar << *Data.STRUCT;
+		if (Ar.IsSaving()) Ar << const_cast<FINStruct&>(*Data.STRUCT);
 		break;
 	default:
 		break;
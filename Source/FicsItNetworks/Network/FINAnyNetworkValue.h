@@ -5,6 +5,26 @@
 
 #include "FINAnyNetworkValue.generated.h"
 
+/**
+ * Storage of a network value.
+ * Objects and traces are stored inline, strings and structs are stored as shared immutable payload,
+ * so copying a value never allocates.
+ * Lifetime of the members is managed by FFINAnyNetworkValue.
+ */
+union FFINAnyNetworkValueData {
+	FINInt		INT;
+	FINFloat	FLOAT;
+	FINBool		BOOL;
+	FINClass	CLASS;
+	FINObj		OBJECT;
+	FINTrace	TRACE;
+	TSharedPtr<const FINStr, ESPMode::ThreadSafe>		STRING;
+	TSharedPtr<const FINStruct, ESPMode::ThreadSafe>	STRUCT;
+
+	FFINAnyNetworkValueData() : INT(0) {}
+	~FFINAnyNetworkValueData() {}
+};
+
 /**
  * This sturcture allows you to store any kind of network value.
  */
@@ -102,7 +122,7 @@ struct FFINAnyNetworkValue {
 	 * @return	the stored object
 	 */
 	const FINObj& GetObject() const {
-		return *Data.OBJECT;
+		return Data.OBJECT;
 	}
 
 	/**
@@ -112,7 +132,7 @@ struct FFINAnyNetworkValue {
 	 * @return	the stored trace
 	 */
 	const FINTrace& GetTrace() const {
-		return *Data.TRACE;
+		return Data.TRACE;
 	}
 
 	/**
@@ -125,6 +145,12 @@ struct FFINAnyNetworkValue {
 		return *Data.STRUCT;
 	}
 
+	/**
+	 * Checks if both values have the same type and are equal.
+	 * Traces are compared by their underlying object, structs by their properties.
+	 */
+	bool operator==(const FFINAnyNetworkValue& Other) const;
+
 	bool Serialize(FArchive& Ar);
 
 	void operator>>(FFINValueReader& Reader) const;
@@ -132,16 +158,12 @@ struct FFINAnyNetworkValue {
 private:
 	TEnumAsByte<EFINNetworkValueType> Type = FIN_NIL;
 	
-	union {
-		FINInt		INT;
-		FINFloat	FLOAT;
-		FINBool		BOOL;
-		FINClass	CLASS;
-		FINStr*		STRING;
-		FINObj*		OBJECT;
-		FINTrace*	TRACE;
-		FINStruct*	STRUCT;
-	} Data;
+	FFINAnyNetworkValueData Data;
+
+	/**
+	 * Destroys the currently stored value and resets the value to nil.
+	 */
+	void Reset();
 };
 
 inline bool operator<<(FArchive& Ar, FFINAnyNetworkValue& Val) {
@@ -1,74 +1,54 @@
 ﻿#include "FINDynamicStructHolder.h"
 
+FFINDynamicStructPayload::~FFINDynamicStructPayload() {
+	if (Data) {
+		Struct->DestroyStruct(Data);
+		FMemory::Free(Data);
+	}
+}
+
 FFINDynamicStructHolder::FFINDynamicStructHolder() {}
 
 FFINDynamicStructHolder::FFINDynamicStructHolder(UScriptStruct* Struct) : Struct(Struct) {
-	Data = FMemory::Malloc(Struct->GetStructureSize());
+	void* Data = FMemory::Malloc(Struct->GetStructureSize());
 	Struct->InitializeStruct(Data);
+	Payload = MakeShared<FFINDynamicStructPayload, ESPMode::ThreadSafe>(Struct, Data);
 }
 
-FFINDynamicStructHolder::FFINDynamicStructHolder(UScriptStruct* Struct, void* Data) : Data(Data), Struct(Struct) {}
-
-FFINDynamicStructHolder::FFINDynamicStructHolder(const FFINDynamicStructHolder& Other) {
-	*this = Other;
+FFINDynamicStructHolder::FFINDynamicStructHolder(UScriptStruct* Struct, void* Data) : Struct(Struct) {
+	if (Data) Payload = MakeShared<FFINDynamicStructPayload, ESPMode::ThreadSafe>(Struct, Data);
 }
 
-FFINDynamicStructHolder::~FFINDynamicStructHolder() {
-	if (Data) {
-		Struct->DestroyStruct(Data);
-		FMemory::Free(Data);
-		Data = nullptr;
-	}
-}
+FFINDynamicStructHolder::FFINDynamicStructHolder(const FFINDynamicStructHolder& Other) : Payload(Other.Payload), Struct(Other.Struct) {}
+
+FFINDynamicStructHolder::~FFINDynamicStructHolder() {}
 
 FFINDynamicStructHolder& FFINDynamicStructHolder::operator=(const FFINDynamicStructHolder& Other) {
-	if (Data) {
-		Struct->DestroyStruct(Data);
-		if (Other.Data) {
-			Data = FMemory::Realloc(Data, Other.Struct->GetStructureSize());
-		} else {
-			FMemory::Free(Data);
-			Data = nullptr;
-		}
-	} else {
-		if (Other.Data) {
-			Data = FMemory::Malloc(Other.Struct->GetStructureSize());
-		}
-	}
+	Payload = Other.Payload;
 	Struct = Other.Struct;
-	if (Data) {
-		Struct->InitializeStruct(Data);
-		Struct->CopyScriptStruct(Data, Other.Data);
-	}
-	
 	return *this;
 }
 
 FFINDynamicStructHolder FFINDynamicStructHolder::Copy(UScriptStruct* Struct, const void* Data) {
 	FFINDynamicStructHolder holder(Struct);
-	if (Data) Struct->CopyScriptStruct(holder.Data, Data);
+	if (Data) Struct->CopyScriptStruct(holder.GetData(), Data);
 	return holder;
 }
 
+void FFINDynamicStructHolder::Detach() {
+	if (!Payload.IsValid() || Payload.IsUnique()) return;
+	*this = Copy(Struct, Payload->Data);
+}
+
 bool FFINDynamicStructHolder::Serialize(FArchive& Ar) {
-	UScriptStruct* OldStruct = Struct;
 	Ar << Struct;
 	if (Ar.IsLoading()) {
-		if (Data) {
-			OldStruct->DestroyStruct(Data);
-			if (Struct) {
-				Data = FMemory::Realloc(Data, Struct->GetStructureSize());
-			} else {
-				FMemory::Free(Data);
-				Data = nullptr;
-			}
-		} else if (Struct) {
-			Data = FMemory::Malloc(Struct->GetStructureSize());
-		}
-		if (Struct) Struct->InitializeStruct(Data);
+		// loading always creates a new payload, other holders might share the old one
+		if (Struct) *this = FFINDynamicStructHolder(Struct);
+		else Payload.Reset();
 	}
 	if (Struct) {
-		Struct->GetCppStructOps()->Serialize(Ar, Data);
+		Struct->GetCppStructOps()->Serialize(Ar, GetData());
 	}
 	return true;
 }
@@ -78,5 +58,10 @@ UScriptStruct* FFINDynamicStructHolder::GetStruct() const {
 }
 
 void* FFINDynamicStructHolder::GetData() const {
-	return Data;
+	return Payload.IsValid() ? Payload->Data : nullptr;
+}
+
+void* FFINDynamicStructHolder::GetMutableData() {
+	Detach();
+	return GetData();
 }
@@ -11,16 +11,37 @@ template<typename T>
 class TFINDynamicStruct;
 
 /**
- * This structure allows you to store any kind of UStruct
+ * The memory of a struct stored in a dynamic struct holder.
+ * Shared by all holders which are copies of each other.
+ */
+struct FFINDynamicStructPayload {
+	UScriptStruct* Struct;
+	void* Data;
+
+	FFINDynamicStructPayload(UScriptStruct* Struct, void* Data) : Struct(Struct), Data(Data) {}
+	FFINDynamicStructPayload(const FFINDynamicStructPayload&) = delete;
+	FFINDynamicStructPayload& operator=(const FFINDynamicStructPayload&) = delete;
+	~FFINDynamicStructPayload();
+};
+
+/**
+ * This structure allows you to store any kind of UStruct.
+ * Copies share the same struct memory, a private copy of the struct
+ * only gets created when it gets accessed mutable while shared (copy-on-write).
  */
 USTRUCT(BlueprintType)
 struct FFINDynamicStructHolder {
 	GENERATED_BODY()
 	
 protected:
-	void* Data = nullptr;
+	TSharedPtr<FFINDynamicStructPayload, ESPMode::ThreadSafe> Payload;
 	UScriptStruct* Struct = nullptr;
 
+	/**
+	 * Makes sure the payload is only used by this holder by copying it if it is shared.
+	 */
+	void Detach();
+
 public:
 	FFINDynamicStructHolder();
 	FFINDynamicStructHolder(UScriptStruct* Struct);
@@ -42,12 +63,27 @@ public:
 	 * @return the stored structs type
 	 */
 	UScriptStruct* GetStruct() const;
-	
+
+	/**
+	 * Returns the struct memory for reading.
+	 * The memory may be shared with other holders, so it is not allowed to get modified.
+	 */
 	void* GetData() const;
 
+	/**
+	 * Returns the struct memory for modification.
+	 * Creates a private copy of the struct if it is shared with other holders.
+	 */
+	void* GetMutableData();
+
 	template<typename T>
-    T& Get() const {
-		return *static_cast<T*>(GetData());
+    const T& Get() const {
+		return *static_cast<const T*>(GetData());
+	}
+
+	template<typename T>
+	T& GetMutable() {
+		return *static_cast<T*>(GetMutableData());
 	}
 
 	template<typename T>
@@ -55,7 +91,7 @@ public:
 		if (Struct->IsChildOf(T::StaticStruct())) {
 			void* Data = FMemory::Malloc(Struct->GetStructureSize());
 			Struct->InitializeStruct(Data);
-			Struct->CopyScriptStruct(Data, this->Data);
+			Struct->CopyScriptStruct(Data, GetData());
 			return MakeShareable(reinterpret_cast<T*>(Data));
 		}
 		return nullptr;
@@ -87,10 +123,10 @@ public:
 	TFINDynamicStruct(UScriptStruct* Struct) : FFINDynamicStructHolder(Struct) { check(Struct->IsChildOf(T::StaticStruct())) }
 	TFINDynamicStruct(UScriptStruct* Struct, void* Data) : FFINDynamicStructHolder(Struct, Data) { check(Struct->IsChildOf(T::StaticStruct())) }
 	template<typename K>
-	TFINDynamicStruct(const TFINDynamicStruct<K>& Other) : FFINDynamicStructHolder(FFINDynamicStructHolder::Copy(Other.GetStruct(), Other.GetData())) {
-		check(Other->GetStruct()->IsChildOf(T::StaticStruct()));
+	TFINDynamicStruct(const TFINDynamicStruct<K>& Other) : FFINDynamicStructHolder(Other) {
+		check(Other.GetStruct()->IsChildOf(T::StaticStruct()));
 	}
-	TFINDynamicStruct(const FFINDynamicStructHolder& Other) : FFINDynamicStructHolder(FFINDynamicStructHolder::Copy(Other.GetStruct(), Other.GetData())) {
+	TFINDynamicStruct(const FFINDynamicStructHolder& Other) : FFINDynamicStructHolder(Other) {
 		check(Other.GetStruct()->IsChildOf(T::StaticStruct()));
 	}
 	template<typename K>
@@ -111,11 +147,11 @@ public:
 		return *this;
 	}
 	
-	T* operator->() const {
+	const T* operator->() const {
 		return &Get<T>();
 	}
 
-	T* operator*() const {
+	const T* operator*() const {
 		return &Get<T>();
 	}
 
@@ -124,7 +160,7 @@ public:
 	}
 
 	operator FFINDynamicStructHolder() const {
-		return FFINDynamicStructHolder::Copy(Struct, Data);
+		return *static_cast<const FFINDynamicStructHolder*>(this);
 	}
 };
 
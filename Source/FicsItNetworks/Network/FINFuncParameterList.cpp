@@ -1,10 +1,12 @@
 ﻿#include "FINFuncParameterList.h"
 
+#include "FINFunctionLayout.h"
 #include "FINStructParameterList.h"
 
-FFINFuncParameterList::FFINFuncParameterList(UFunction* Func) {
-	Data = FMemory::Malloc(Func->GetStructureSize());
-	Func->InitializeStruct(Data);
+FFINFuncParameterList::FFINFuncParameterList(UFunction* Func) : Func(Func) {
+	const FFINFunctionLayout& Layout = FFINFunctionLayout::Get(Func);
+	Data = FMemory::Malloc(Layout.ParmsSize, Layout.Alignment);
+	Layout.Initialize(Data);
 }
 
 FFINFuncParameterList::FFINFuncParameterList(UFunction* Func, void* Data) : Func(Func), Data(Data) {}
@@ -14,30 +16,30 @@ FFINFuncParameterList::FFINFuncParameterList(const FFINFuncParameterList& Other)
 
 FFINFuncParameterList::~FFINFuncParameterList() {
 	if (Data) {
-		Func->DestroyStruct(Data);
+		FFINFunctionLayout::Get(Func).Destroy(Data);
 		FMemory::Free(Data);
 		Data = nullptr;
 	}
 }
 
 FFINFuncParameterList& FFINFuncParameterList::operator=(const FFINFuncParameterList& Other) {
+	if (this == &Other) return *this;
+	if (Data && Other.Data && Func == Other.Func) {
+		// same layout -> copy values in place
+		FFINFunctionLayout::Get(Func).Copy(Data, Other.Data);
+		return *this;
+	}
 	if (Data) {
-		Func->DestroyStruct(Data);
-		if (Other.Data) {
-			Data = FMemory::Realloc(Data, Other.Func->GetStructureSize());
-		} else {
-			FMemory::Free(Data);
-			Data = nullptr;
-		}
-	} else if (Other.Data) {
-		Data = FMemory::Malloc(Other.Func->GetStructureSize());
+		FFINFunctionLayout::Get(Func).Destroy(Data);
+		FMemory::Free(Data);
+		Data = nullptr;
 	}
 	Func = Other.Func;
-	if (Data) {
-		Func->InitializeStruct(Data);
-		for (TFieldIterator<UProperty> It(Func); It; ++It) {
-			It->CopyCompleteValue_InContainer(Data, Other.Data);
-		}
+	if (Other.Data) {
+		const FFINFunctionLayout& Layout = FFINFunctionLayout::Get(Func);
+		Data = FMemory::Malloc(Layout.ParmsSize, Layout.Alignment);
+		Layout.Initialize(Data);
+		Layout.Copy(Data, Other.Data);
 	}
 	
 	return *this;
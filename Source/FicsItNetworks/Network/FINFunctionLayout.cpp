@@ -0,0 +1,62 @@
+#include "FINFunctionLayout.h"
+
+#include "FINDynamicStructHolder.h"
+#include "Misc/ScopeRWLock.h"
+
+FFINFunctionLayout::FFINFunctionLayout(UFunction* Func) : Func(Func) {
+	ParmsSize = Func->GetStructureSize();
+	Alignment = Func->GetMinAlignment();
+	FString FuncName = Func->GetName();
+	if (!FuncName.RemoveFromStart(TEXT("netFunc_"))) FuncName.RemoveFromStart(TEXT("netSig_"));
+	Name = FuncName;
+	for (TFieldIterator<UProperty> Prop(Func); Prop; ++Prop) {
+		EPropertyFlags Flags = Prop->GetPropertyFlags();
+		if (!(Flags & CPF_Parm)) continue;
+		Params.Add(*Prop);
+		if (Flags & (CPF_OutParm | CPF_ReturnParm)) {
+			OutParams.Add(*Prop);
+		} else {
+			InParams.Add(*Prop);
+			UStructProperty* StructProp = Cast<UStructProperty>(*Prop);
+			if (StructProp && StructProp->Struct == FFINDynamicStructHolder::StaticStruct()) VariadicParam = StructProp;
+		}
+		if (!(Flags & CPF_IsPlainOldData)) NonTrivialParams.Add(*Prop);
+	}
+}
+
+void FFINFunctionLayout::Initialize(void* Data) const {
+	FMemory::Memzero(Data, ParmsSize);
+	for (UProperty* Prop : NonTrivialParams) {
+		if (!Prop->HasAnyPropertyFlags(CPF_ZeroConstructor)) Prop->InitializeValue_InContainer(Data);
+	}
+}
+
+void FFINFunctionLayout::Destroy(void* Data) const {
+	for (UProperty* Prop : NonTrivialParams) {
+		if (!Prop->HasAnyPropertyFlags(CPF_NoDestructor)) Prop->DestroyValue_InContainer(Data);
+	}
+}
+
+void FFINFunctionLayout::Copy(void* Dest, const void* Src) const {
+	if (NonTrivialParams.Num() < 1) {
+		FMemory::Memcpy(Dest, Src, ParmsSize);
+		return;
+	}
+	for (UProperty* Prop : Params) {
+		Prop->CopyCompleteValue_InContainer(Dest, Src);
+	}
+}
+
+const FFINFunctionLayout& FFINFunctionLayout::Get(UFunction* Func) {
+	static FRWLock Lock;
+	static TMap<UFunction*, TUniquePtr<FFINFunctionLayout>> Layouts;
+	{
+		FReadScopeLock ReadLock(Lock);
+		TUniquePtr<FFINFunctionLayout>* Layout = Layouts.Find(Func);
+		if (Layout) return **Layout;
+	}
+	FWriteScopeLock WriteLock(Lock);
+	TUniquePtr<FFINFunctionLayout>& Layout = Layouts.FindOrAdd(Func);
+	if (!Layout) Layout = MakeUnique<FFINFunctionLayout>(Func);
+	return *Layout;
+}
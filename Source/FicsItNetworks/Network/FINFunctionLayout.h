@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "FINName.h"
+
+/**
+ * Precomputed parameter layout of a function.
+ * Allows to initialize, copy and destroy parameter structs of the function
+ * and to access its in- and out-parameters without iterating the properties every time.
+ * Layouts get created once per function and stay valid for the lifetime of the game.
+ */
+struct FFINFunctionLayout {
+	/**
+	 * The function this layout describes.
+	 */
+	UFunction* Func = nullptr;
+
+	/**
+	 * The name of the function without its "netFunc_" or "netSig_" prefix.
+	 */
+	FFINName Name;
+
+	/**
+	 * The size and alignment a parameter struct of the function needs.
+	 */
+	int32 ParmsSize = 0;
+	int32 Alignment = 1;
+
+	/**
+	 * All parameters of the function in declaration order.
+	 */
+	TArray<UProperty*> Params;
+
+	/**
+	 * All input parameters of the function in declaration order.
+	 */
+	TArray<UProperty*> InParams;
+
+	/**
+	 * All out- and return-parameters of the function in declaration order.
+	 */
+	TArray<UProperty*> OutParams;
+
+	/**
+	 * The input parameter receiving variadic arguments, nullptr if the function has none.
+	 */
+	UStructProperty* VariadicParam = nullptr;
+
+	/**
+	 * Parameters which are not plain old data and so need to get constructed, copied and destroyed individually.
+	 */
+	TArray<UProperty*> NonTrivialParams;
+
+	explicit FFINFunctionLayout(UFunction* Func);
+
+	/**
+	 * Initializes the given uninitialized memory as parameter struct of the function.
+	 *
+	 * @param[in]	Data	the memory of at least ParmsSize bytes
+	 */
+	void Initialize(void* Data) const;
+
+	/**
+	 * Destroys the parameter values of the given parameter struct without freeing its memory.
+	 *
+	 * @param[in]	Data	the initialized parameter struct
+	 */
+	void Destroy(void* Data) const;
+
+	/**
+	 * Copies all parameter values from one initialized parameter struct to another.
+	 *
+	 * @param[in]	Dest	the parameter struct you want to copy to
+	 * @param[in]	Src		the parameter struct you want to copy from
+	 */
+	void Copy(void* Dest, const void* Src) const;
+
+	/**
+	 * Returns the layout of the given function, creating it if it doesn't exist yet.
+	 * Thread safe.
+	 *
+	 * @param[in]	Func	the function you want to get the layout of
+	 * @return	the layout of the function
+	 */
+	static const FFINFunctionLayout& Get(UFunction* Func);
+};
@@ -4,18 +4,49 @@
 #include "FINSubsystemHolder.h"
 #include "Signals/FINSignalListener.h"
 #include "Signals/FINSignalSender.h"
+#include "Signals/FINSmartSignal.h"
 #include "util/Logging.h"
 
 TMap<UClass*, TSet<TSubclassOf<UFINHook>>> AFINHookSubsystem::HookRegistry;
 
 bool FFINHookData::Serialize(FArchive& Ar) {
 	Ar << Listeners;
+	if (Ar.IsLoading()) UpdateListenerSnapshot();
 	return true;
 }
 
+void FFINHookData::UpdateListenerSnapshot() {
+	TSharedPtr<TArray<FFINSignalListenerEntry>, ESPMode::ThreadSafe> Snapshot = MakeShared<TArray<FFINSignalListenerEntry>, ESPMode::ThreadSafe>();
+	Snapshot->Reserve(Listeners.Num());
+	for (const FFINNetworkTrace& Listener : Listeners) {
+		Snapshot->Add(FFINSignalListenerEntry{Listener, Listener.Reverse(), CoalescingListeners.Contains(Listener)});
+	}
+	ListenerSnapshot = Snapshot;
+}
+
+AFINHookSubsystem::AFINHookSubsystem() {
+	SetActorTickEnabled(true);
+	PrimaryActorTick.SetTickFunctionEnable(true);
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+}
+
 void AFINHookSubsystem::Serialize(FArchive& Ar) {
 	Super::Serialize(Ar);
 	Ar << Data;
+	if (Ar.IsSaveGame() && Version >= EFINCustomVersion::FINHookCoalescing) {
+		TMap<UObject*, TSet<FFINNetworkTrace>> Coalescing;
+		if (Ar.IsSaving()) for (const TTuple<UObject*, FFINHookData>& data : Data) {
+			if (data.Value.CoalescingListeners.Num() > 0) Coalescing.Add(data.Key, data.Value.CoalescingListeners);
+		}
+		Ar << Coalescing;
+		if (Ar.IsLoading()) for (TTuple<UObject*, TSet<FFINNetworkTrace>>& coalescing : Coalescing) {
+			FFINHookData* HookData = Data.Find(coalescing.Key);
+			if (!HookData) continue;
+			HookData->CoalescingListeners = coalescing.Value;
+			HookData->UpdateListenerSnapshot();
+		}
+	}
 	if (Ar.IsLoading()) {
 		for (const TTuple<UObject*, FFINHookData>& data : Data) {
 			AttachHooks(data.Key);
@@ -26,6 +57,17 @@ void AFINHookSubsystem::Serialize(FArchive& Ar) {
 	}
 }
 
+void AFINHookSubsystem::BeginPlay() {
+	Super::BeginPlay();
+
+	Version = EFINCustomVersion::FINLatestVersion;
+}
+
+void AFINHookSubsystem::Tick(float dt) {
+	Super::Tick(dt);
+	FlushCoalescedSignals();
+}
+
 bool AFINHookSubsystem::ShouldSave_Implementation() const {
 	return true;
 }
@@ -39,23 +81,98 @@ void AFINHookSubsystem::RegisterHook(UClass* clazz, TSubclassOf<UFINHook> hook)
 }
 
 TSet<FFINNetworkTrace> AFINHookSubsystem::GetListeners(UObject* object) const {
-	TSet<FFINNetworkTrace> traces;
-	for (const FFINNetworkTrace& trace : Data[object].Listeners) {
-		traces.Add(trace);
+	FReadScopeLock Lock(DataLock);
+	const FFINHookData* HookData = Data.Find(object);
+	if (HookData) return HookData->Listeners;
+	return TSet<FFINNetworkTrace>();
+}
+
+FFINSignalListenerSnapshot AFINHookSubsystem::GetListenerSnapshot(UObject* object) const {
+	FReadScopeLock Lock(DataLock);
+	const FFINHookData* HookData = Data.Find(object);
+	if (!HookData) return nullptr;
+	return HookData->ListenerSnapshot;
+}
+
+void AFINHookSubsystem::EmitSignalToListeners(const FFINSignalListenerSnapshot& listeners, const TFINDynamicStruct<FFINSignal>& signal, bool bCoalesced) {
+	for (const FFINSignalListenerEntry& Listener : *listeners) {
+		if (Listener.bCoalesce != bCoalesced) continue;
+		IFINSignalListener* obj = Cast<IFINSignalListener>(*Listener.Listener);
+		if (obj) obj->HandleSignal(signal, Listener.Sender);
 	}
-	return traces;
 }
 
 void AFINHookSubsystem::EmitSignal(UObject* object, const TFINDynamicStruct<FFINSignal>& signal) {
-	for (FFINNetworkTrace trace : GetListeners(object)) {
-		IFINSignalListener* obj = Cast<IFINSignalListener>(*trace);
-		if (obj) obj->HandleSignal(signal, trace.Reverse());
+	FFINSignalListenerSnapshot Listeners = GetListenerSnapshot(object);
+	if (!Listeners) return;
+	for (const FFINSignalListenerEntry& Listener : *Listeners) {
+		IFINSignalListener* obj = Cast<IFINSignalListener>(*Listener.Listener);
+		if (obj) obj->HandleSignal(signal, Listener.Sender);
 	}
 }
 
+void AFINHookSubsystem::EmitSignalCoalesced(UObject* object, const FString& name, const TArray<FFINAnyNetworkValue>& args) {
+	FFINSignalListenerSnapshot Listeners = GetListenerSnapshot(object);
+	if (!Listeners) return;
+	bool bDirect = false;
+	bool bCoalesced = false;
+	for (const FFINSignalListenerEntry& Listener : *Listeners) {
+		if (Listener.bCoalesce) bCoalesced = true;
+		else bDirect = true;
+	}
+	if (bDirect) EmitSignalToListeners(Listeners, FFINSmartSignal(name, args), false);
+	if (!bCoalesced) return;
+	
+	FFINCoalescedSignal Previous;
+	{
+		FFINCoalescedSignalShard& Shard = CoalescedSignals[PointerHash(object) % CoalescedSignalShardCount];
+		FScopeLock Lock(&Shard.Mutex);
+		FFINCoalescedSignal& Pending = Shard.Signals.FindOrAdd(object);
+		if (Pending.Count > 0 && Pending.Name == name && Pending.Args == args) {
+			++Pending.Count;
+			return;
+		}
+		Previous = Pending;
+		Pending.Name = name;
+		Pending.Args = args;
+		Pending.Count = 1;
+	}
+	if (Previous.Count > 0) EmitCoalescedSignal(object, Previous);
+}
+
+void AFINHookSubsystem::FlushCoalescedSignals() {
+	for (FFINCoalescedSignalShard& Shard : CoalescedSignals) {
+		TMap<TWeakObjectPtr<UObject>, FFINCoalescedSignal> Signals;
+		{
+			FScopeLock Lock(&Shard.Mutex);
+			if (Shard.Signals.Num() < 1) continue;
+			Signals = MoveTemp(Shard.Signals);
+			Shard.Signals.Reset();
+		}
+		for (const TPair<TWeakObjectPtr<UObject>, FFINCoalescedSignal>& Signal : Signals) {
+			UObject* Obj = Signal.Key.Get();
+			if (Obj && Signal.Value.Count > 0) EmitCoalescedSignal(Obj, Signal.Value);
+		}
+	}
+}
+
+void AFINHookSubsystem::EmitCoalescedSignal(UObject* object, const FFINCoalescedSignal& signal) {
+	FFINSignalListenerSnapshot Listeners = GetListenerSnapshot(object);
+	if (!Listeners) return;
+	TArray<FFINAnyNetworkValue> Args = signal.Args;
+	Args.Add(FFINAnyNetworkValue(static_cast<FINInt>(signal.Count)));
+	const TArray<FFINAnyNetworkValue>& ConstArgs = Args;
+	EmitSignalToListeners(Listeners, FFINSmartSignal(signal.Name, ConstArgs), true);
+}
+
 void AFINHookSubsystem::AttachHooks(UObject* object) {
+	FWriteScopeLock Lock(DataLock);
+	AttachHooksInternal(object);
+}
+
+void AFINHookSubsystem::AttachHooksInternal(UObject* object) {
 	if (!IsValid(object)) return;
-	ClearHooks(object);
+	ClearHooksInternal(object);
 	FFINHookData& HookData = Data.FindOrAdd(object);
 	UClass* clazz = object->GetClass();
 	while (clazz) {
@@ -75,6 +192,11 @@ void AFINHookSubsystem::AttachHooks(UObject* object) {
 }
 
 void AFINHookSubsystem::ClearHooks(UObject* object) {
+	FWriteScopeLock Lock(DataLock);
+	ClearHooksInternal(object);
+}
+
+void AFINHookSubsystem::ClearHooksInternal(UObject* object) {
 	FFINHookData* data = Data.Find(object);
 	if (!data) return;
 	for (UFINHook* hook : data->Hooks) {
@@ -83,14 +205,25 @@ void AFINHookSubsystem::ClearHooks(UObject* object) {
 	data->Hooks.Empty();
 }
 
-void AFINHookSubsystem::AddListener(UObject* sender, FFINNetworkTrace listener) {
-	AttachHooks(sender);
-	Data[sender].Listeners.Add(listener);
+void AFINHookSubsystem::AddListener(UObject* sender, FFINNetworkTrace listener, bool bCoalesce) {
+	FWriteScopeLock Lock(DataLock);
+	AttachHooksInternal(sender);
+	FFINHookData* HookDataPtr = Data.Find(sender);
+	if (!HookDataPtr) return;
+	FFINHookData& HookData = *HookDataPtr;
+	HookData.Listeners.Add(listener);
+	if (bCoalesce) HookData.CoalescingListeners.Add(listener);
+	else HookData.CoalescingListeners.Remove(listener);
+	HookData.UpdateListenerSnapshot();
 }
 
 void AFINHookSubsystem::RemoveListener(UObject* sender, UObject* listener) {
-	TSet<FFINNetworkTrace>& traces = Data[sender].Listeners;
-	traces.Remove(FFINNetworkTrace(listener));
-	if (traces.Num() < 1) ClearHooks(sender);
+	FWriteScopeLock Lock(DataLock);
+	FFINHookData* HookData = Data.Find(sender);
+	if (!HookData) return;
+	HookData->Listeners.Remove(FFINNetworkTrace(listener));
+	HookData->CoalescingListeners.Remove(FFINNetworkTrace(listener));
+	HookData->UpdateListenerSnapshot();
+	if (HookData->Listeners.Num() < 1) ClearHooksInternal(sender);
 }
 
@@ -1,8 +1,12 @@
 ﻿#pragma once
 #include "FGSaveInterface.h"
 #include "FGSubsystem.h"
+#include "FicsItNetworksCustomVersion.h"
+#include "FINAnyNetworkValue.h"
 #include "FINNetworkTrace.h"
 #include "Signals/FINSignal.h"
+#include "Signals/FINSignalListener.h"
+#include "Misc/ScopeRWLock.h"
 #include "FINHookSubsystem.generated.h"
 
 UCLASS(Abstract)
@@ -26,7 +30,23 @@ struct FICSITNETWORKS_API FFINHookData {
 	UPROPERTY()
 	TSet<UFINHook*> Hooks;
 
+	/**
+	 * The listeners which want consecutive identical signals to get aggregated.
+	 */
+	UPROPERTY()
+	TSet<FFINNetworkTrace> CoalescingListeners;
+
+	/**
+	 * Immutable snapshot of the listeners used to emit signals.
+	 */
+	FFINSignalListenerSnapshot ListenerSnapshot;
+
 	bool Serialize(FArchive& Ar);
+
+	/**
+	 * Rebuilds the listener snapshot from the listener list.
+	 */
+	void UpdateListenerSnapshot();
 };
 
 inline FArchive& operator<<(FArchive& Ar, FFINHookData& data) {
@@ -34,6 +54,23 @@ inline FArchive& operator<<(FArchive& Ar, FFINHookData& data) {
 	return Ar;
 }
 
+/**
+ * A signal waiting to get emitted which aggregates consecutive identical signals of a object.
+ */
+struct FFINCoalescedSignal {
+	FString Name;
+	TArray<FFINAnyNetworkValue> Args;
+	int64 Count = 0;
+};
+
+/**
+ * A part of the pending coalesced signals, so emitting objects only contend with the objects in the same shard.
+ */
+struct FFINCoalescedSignalShard {
+	TMap<TWeakObjectPtr<UObject>, FFINCoalescedSignal> Signals;
+	FCriticalSection Mutex;
+};
+
 UCLASS()
 class AFINHookSubsystem : public AFGSubsystem, public IFGSaveInterface {
 	GENERATED_BODY()
@@ -44,21 +81,69 @@ private:
 	UPROPERTY()
 	TMap<UObject*, FFINHookData> Data;
 
+	/**
+	 * Guards the hook data map and the listener snapshots in it,
+	 * signals may get emitted by hooks from any thread.
+	 */
+	mutable FRWLock DataLock;
+
 	/**
 	 * Contains the list of hooks accosiated with a class
 	 */
 	static TMap<UClass*, TSet<TSubclassOf<UFINHook>>> HookRegistry;
 
+	/**
+	 * Contains the pending coalesced signal of all objects which emitted one since the last flush,
+	 * sharded by the object.
+	 */
+	static constexpr int32 CoalescedSignalShardCount = 16;
+	FFINCoalescedSignalShard CoalescedSignals[CoalescedSignalShardCount];
+
+	/**
+	 * Attaches all hooks to the given object, the data lock has to be write locked by the caller.
+	 */
+	void AttachHooksInternal(UObject* object);
+
+	/**
+	 * Removes all hook attachments from the given object, the data lock has to be write locked by the caller.
+	 */
+	void ClearHooksInternal(UObject* object);
+
+	/**
+	 * Returns the listener snapshot of the given object.
+	 */
+	FFINSignalListenerSnapshot GetListenerSnapshot(UObject* object) const;
+
+	/**
+	 * Sends the given signal to the listeners of the snapshot which want coalesced signals, or to the ones which don't.
+	 */
+	static void EmitSignalToListeners(const FFINSignalListenerSnapshot& listeners, const TFINDynamicStruct<FFINSignal>& signal, bool bCoalesced);
+
+	/**
+	 * Emits the given coalesced signal with the count of aggregated signals as additional last parameter.
+	 */
+	void EmitCoalescedSignal(UObject* object, const FFINCoalescedSignal& signal);
+
 public:
 	/**
     * Contains a list of classes that have registered a netSig
     */
     UPROPERTY(SaveGame)
     TSet<UClass*> ClassesWithSignals;
+
+	UPROPERTY(SaveGame)
+	TEnumAsByte<EFINCustomVersion> Version = EFINCustomVersion::FINBeforeCustomVersionWasAdded;
+	
+	AFINHookSubsystem();
 	
 	// Begin UObject
 	virtual void Serialize(FArchive& Ar) override;
 	// End UObject
+
+	// Begin AActor
+	virtual void BeginPlay() override;
+	virtual void Tick(float dt) override;
+	// End AActor
 	
 	// Begin IFGSaveInterface
 	virtual bool ShouldSave_Implementation() const override;
@@ -96,6 +181,26 @@ public:
 	 * @param[in]	signal	the signal that the object shouls emit
 	 */
 	void EmitSignal(UObject* object, const TFINDynamicStruct<FFINSignal>& signal);
+
+	/**
+	 * Sends the given signal to all listeners of the given object.
+	 * For listeners which opted into coalescing, the signal gets aggregated with
+	 * consecutive signals of the object with the same name and parameters instead.
+	 * The aggregated signal gets emitted once a different signal is emitted by the object or
+	 * at the latest in the next tick of the subsystem.
+	 * The aggregated signal has the count of aggregated signals as additional last parameter.
+	 * Thread safe, used for high frequency hooks.
+	 *
+	 * @param[in]	object	the object that should emit the signal
+	 * @param[in]	name	the name of the signal
+	 * @param[in]	args	the parameters of the signal
+	 */
+	void EmitSignalCoalesced(UObject* object, const FString& name, const TArray<FFINAnyNetworkValue>& args);
+
+	/**
+	 * Emits all pending coalesced signals.
+	 */
+	void FlushCoalescedSignals();
 	
 	/**
 	 * Attaches all hooks to the given object there are for the type of the given object.
@@ -118,8 +223,9 @@ public:
 	 *
 	 * @param[in]	sender		the object you want to add the listener to
 	 * @param[in]	listener	the listener you want to add to the listener list
+	 * @param[in]	bCoalesce	true if the listener wants signals of high frequency hooks to get aggregated
 	 */
-	void AddListener(UObject* sender, FFINNetworkTrace listener);
+	void AddListener(UObject* sender, FFINNetworkTrace listener, bool bCoalesce = false);
 
 	/**
 	 * Removes the given listener from the listener list of the given object.
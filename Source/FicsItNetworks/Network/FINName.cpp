@@ -0,0 +1,116 @@
+#include "FINName.h"
+
+#include <atomic>
+#include <unordered_map>
+
+#include "Misc/ScopeRWLock.h"
+
+/**
+ * Global table of all interned names.
+ * Entries are stored in chunks which never move or get freed,
+ * so entries can be read by id without taking the lock.
+ */
+class FFINNameTable {
+private:
+	static constexpr int32 ChunkSize = 1024;
+	static constexpr int32 MaxChunks = 1024;
+
+	struct FEntry {
+		FString Name;
+		std::string UTF8;
+	};
+
+	FRWLock Lock;
+	std::unordered_map<std::string, int32> Ids;
+	std::atomic<FEntry*> Chunks[MaxChunks] = {};
+	int32 Count = 0;
+
+	FFINNameTable() {
+		Add(std::string());
+	}
+
+	int32 Add(std::string&& UTF8) {
+		const int32 Id = Count;
+		checkf(Id / ChunkSize < MaxChunks, TEXT("FIN name table is full"));
+		FEntry* Chunk = Chunks[Id / ChunkSize].load(std::memory_order_relaxed);
+		if (!Chunk) {
+			Chunk = new FEntry[ChunkSize];
+			Chunks[Id / ChunkSize].store(Chunk, std::memory_order_release);
+		}
+		FEntry& Entry = Chunk[Id % ChunkSize];
+		Entry.Name = UTF8_TO_TCHAR(UTF8.c_str());
+		Entry.UTF8 = UTF8;
+		Ids.emplace(std::move(UTF8), Id);
+		++Count;
+		return Id;
+	}
+
+public:
+	static FFINNameTable& Get() {
+		static FFINNameTable Table;
+		return Table;
+	}
+
+	int32 Intern(const char* Name, std::size_t Len) {
+		std::string UTF8(Name, Len);
+		{
+			FReadScopeLock ReadLock(Lock);
+			auto Id = Ids.find(UTF8);
+			if (Id != Ids.end()) return Id->second;
+		}
+		FWriteScopeLock WriteLock(Lock);
+		auto Id = Ids.find(UTF8);
+		if (Id != Ids.end()) return Id->second;
+		return Add(std::move(UTF8));
+	}
+
+	bool Find(const char* Name, std::size_t Len, int32& OutId) {
+		FReadScopeLock ReadLock(Lock);
+		auto Id = Ids.find(std::string(Name, Len));
+		if (Id == Ids.end()) return false;
+		OutId = Id->second;
+		return true;
+	}
+
+	const FEntry& GetEntry(int32 Id) const {
+		return Chunks[Id / ChunkSize].load(std::memory_order_acquire)[Id % ChunkSize];
+	}
+};
+
+FFINName::FFINName(const FString& Name) : FFINName(*Name) {}
+
+FFINName::FFINName(const TCHAR* Name) {
+	FTCHARToUTF8 UTF8(Name);
+	Id = FFINNameTable::Get().Intern(UTF8.Get(), UTF8.Length());
+}
+
+FFINName::FFINName(const ANSICHAR* Name) {
+	Id = FFINNameTable::Get().Intern(Name, FCStringAnsi::Strlen(Name));
+}
+
+FFINName FFINName::FromUTF8(const char* Name, std::size_t Len) {
+	return FFINName(FFINNameTable::Get().Intern(Name, Len));
+}
+
+bool FFINName::FindUTF8(const char* Name, std::size_t Len, FFINName& OutName) {
+	int32 Id;
+	if (!FFINNameTable::Get().Find(Name, Len, Id)) return false;
+	OutName = FFINName(Id);
+	return true;
+}
+
+const FString& FFINName::ToString() const {
+	return FFINNameTable::Get().GetEntry(Id).Name;
+}
+
+const std::string& FFINName::ToUTF8() const {
+	return FFINNameTable::Get().GetEntry(Id).UTF8;
+}
+
+FArchive& operator<<(FArchive& Ar, FFINName& Name) {
+	FString Str;
+	if (Ar.IsSaving()) Str = Name.ToString();
+	Ar << Str;
+	if (Ar.IsLoading()) Name = FFINName(Str);
+	return Ar;
+}
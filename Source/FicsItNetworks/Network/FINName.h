@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <string>
+
+/**
+ * Interned name used for signal, member and struct type names.
+ * The string of every name is stored once in a global table and the name itself is just the id of the entry,
+ * so comparing, hashing and copying names are integer operations.
+ * Ids are stable for the lifetime of the process, but not across sessions, so they must never get saved.
+ * Thread safe.
+ */
+struct FICSITNETWORKS_API FFINName {
+private:
+	int32 Id = 0;
+
+	explicit FFINName(int32 Id) : Id(Id) {}
+
+public:
+	/**
+	 * Creates the empty name.
+	 */
+	FFINName() = default;
+
+	/**
+	 * Interns the given string, adding it to the name table if it isn't already part of it.
+	 */
+	FFINName(const FString& Name);
+	FFINName(const TCHAR* Name);
+	FFINName(const ANSICHAR* Name);
+
+	/**
+	 * Interns the given UTF-8 string, adding it to the name table if it isn't already part of it.
+	 */
+	static FFINName FromUTF8(const char* Name, std::size_t Len);
+
+	/**
+	 * Trys to find the name of the given UTF-8 string without adding it to the name table.
+	 * Use this for strings coming from scripts, so they can't flood the table.
+	 *
+	 * @param[in]	Name	the string you want to find the name of
+	 * @param[in]	Len		the length of the string in bytes
+	 * @param[out]	OutName	gets set to the found name
+	 * @return	true if the name got found
+	 */
+	static bool FindUTF8(const char* Name, std::size_t Len, FFINName& OutName);
+
+	/**
+	 * Returns the id of the name. The empty name has the id 0.
+	 */
+	int32 GetId() const { return Id; }
+
+	/**
+	 * Returns the string of the name.
+	 */
+	const FString& ToString() const;
+
+	/**
+	 * Returns the UTF-8 encoded string of the name.
+	 */
+	const std::string& ToUTF8() const;
+
+	bool IsEmpty() const { return Id == 0; }
+
+	bool operator==(const FFINName& Other) const { return Id == Other.Id; }
+	bool operator!=(const FFINName& Other) const { return Id != Other.Id; }
+
+	friend uint32 GetTypeHash(const FFINName& Name) {
+		return GetTypeHash(Name.Id);
+	}
+
+	/**
+	 * De/Serializes the name as string, so saves don't depend on the ids.
+	 */
+	friend FArchive& operator<<(FArchive& Ar, FFINName& Name);
+};
@@ -1,15 +1,166 @@
 #include "FINNetworkCircuit.h"
 
 #include "FINNetworkComponent.h"
+#include "FINNetworkMessageInterface.h"
+#include "FINNetworkTrace.h"
+#include "Misc/CoreDelegates.h"
 
-void UFINNetworkCircuit::AddNodeRecursive(TSet<TScriptInterface<IFINNetworkCircuitNode>>& Added, TScriptInterface<IFINNetworkCircuitNode> Add) {
-	if (Add.GetObject() && !Added.Contains(Add)) {
-		Added.Add(Add);
-		Nodes.Add(Add.GetObject());
-		IFINNetworkCircuitNode::Execute_SetCircuit(Add.GetObject(), this);
-		TSet<UObject*> Nodes = IFINNetworkCircuitNode::Execute_GetConnected(Add.GetObject());
-		for (UObject* Node : Nodes) {
-			AddNodeRecursive(Added, Node);
+TMap<TWeakObjectPtr<UObject>, TArray<FFINQueuedNetworkUpdate>> UFINNetworkCircuit::QueuedNetworkUpdates;
+FDelegateHandle UFINNetworkCircuit::FlushNetworkUpdatesHandle;
+
+void UFINNetworkCircuit::AddConnectedNodes(UObject* Start, bool bSkipAssigned) {
+	if (!Start) return;
+	TSet<UObject*> Added;
+	TArray<UObject*> Pending;
+	Added.Add(Start);
+	Pending.Add(Start);
+	while (Pending.Num() > 0) {
+		UObject* Node = Pending.Pop(false);
+		AddNode(Node);
+		for (UObject* Connected : IFINNetworkCircuitNode::Execute_GetConnected(Node)) {
+			if (!Connected || Added.Contains(Connected)) continue;
+			if (bSkipAssigned && IFINNetworkCircuitNode::Execute_GetCircuit(Connected)) continue;
+			Added.Add(Connected);
+			Pending.Add(Connected);
+		}
+	}
+}
+
+void UFINNetworkCircuit::AddNode(UObject* Node) {
+	Nodes.Add(Node);
+	AddToIndex(Node);
+	IFINNetworkCircuitNode::Execute_SetCircuit(Node, this);
+}
+
+void UFINNetworkCircuit::RemoveNode(UObject* Node) {
+	Nodes.Remove(Node);
+	RemoveFromIndex(Node);
+}
+
+bool UFINNetworkCircuit::FindSmallerSide(UObject* A, UObject* B, TSet<UObject*>& OutSide) {
+	TSet<UObject*> Visited[2];
+	TArray<UObject*> Pending[2];
+	Visited[0].Add(A);
+	Visited[1].Add(B);
+	Pending[0].Add(A);
+	Pending[1].Add(B);
+
+	// expand both sides one node at a time, the first side running out of nodes is the smaller one
+	while (true) {
+		for (int Side = 0; Side < 2; ++Side) {
+			if (Pending[Side].Num() < 1) {
+				OutSide = MoveTemp(Visited[Side]);
+				return true;
+			}
+			UObject* Node = Pending[Side].Pop(false);
+			for (UObject* Connected : IFINNetworkCircuitNode::Execute_GetConnected(Node)) {
+				if (!Connected || Visited[Side].Contains(Connected)) continue;
+				if (Visited[1 - Side].Contains(Connected)) return false;
+				Visited[Side].Add(Connected);
+				Pending[Side].Add(Connected);
+			}
+		}
+	}
+}
+
+void UFINNetworkCircuit::AddToIndex(UObject* Node) {
+	if (!Node) return;
+	const bool bComponent = Node->Implements<UFINNetworkComponent>();
+	IFINNetworkMessageInterface* MessageInterface = Cast<IFINNetworkMessageInterface>(Node);
+	if (!bComponent && !MessageInterface) return;
+
+	// query the component before locking, the index only gets locked for the update itself
+	FFINCircuitIndexEntry NewEntry;
+	if (bComponent) {
+		NewEntry.ID = IFINNetworkComponent::Execute_GetID(Node);
+		NewEntry.NickTokens = GetNickTokens(IFINNetworkComponent::Execute_GetNick(Node));
+	}
+	if (MessageInterface) NewEntry.Ports = MessageInterface->GetOpenPorts().Array();
+
+	FWriteScopeLock Lock(IndexLock);
+	RemoveFromIndexInternal(Node);
+	
+	FFINCircuitIndexEntry& Entry = IndexedComponents.Add(Node, MoveTemp(NewEntry));
+	if (bComponent) {
+		ComponentsByID.Add(Entry.ID, Node);
+		for (const FString& Token : Entry.NickTokens) {
+			ComponentsByNickToken.FindOrAdd(Token).Add(Node);
+		}
+	}
+	for (int Port : Entry.Ports) {
+		PortListeners.FindOrAdd(Port).Add(Node);
+	}
+}
+
+void UFINNetworkCircuit::RemoveFromIndex(UObject* Node) {
+	FWriteScopeLock Lock(IndexLock);
+	RemoveFromIndexInternal(Node);
+}
+
+void UFINNetworkCircuit::RemoveFromIndexInternal(UObject* Node) {
+	FFINCircuitIndexEntry Entry;
+	if (!IndexedComponents.RemoveAndCopyValue(Node, Entry)) return;
+	ComponentsByID.RemoveSingle(Entry.ID, Node);
+	for (const FString& Token : Entry.NickTokens) {
+		TSet<TWeakObjectPtr<UObject>>* Components = ComponentsByNickToken.Find(Token);
+		if (!Components) continue;
+		Components->Remove(Node);
+		if (Components->Num() < 1) ComponentsByNickToken.Remove(Token);
+	}
+	for (int Port : Entry.Ports) {
+		TSet<TWeakObjectPtr<UObject>>* Listeners = PortListeners.Find(Port);
+		if (!Listeners) continue;
+		Listeners->Remove(Node);
+		if (Listeners->Num() < 1) PortListeners.Remove(Port);
+	}
+}
+
+TArray<FString> UFINNetworkCircuit::GetNickTokens(const FString& Nick) {
+	TArray<FString> Tokens;
+	Nick.ParseIntoArray(Tokens, TEXT(" "), true);
+	return Tokens;
+}
+
+void UFINNetworkCircuit::QueueNetworkUpdate(const TSet<UObject*>& Nodes, int32 Type, const TSet<UObject*>& Changed) {
+	TSharedRef<TSet<FGuid>> Components = MakeShared<TSet<FGuid>>();
+	for (UObject* Node : Changed) {
+		if (Node && Node->Implements<UFINNetworkComponent>()) Components->Add(IFINNetworkComponent::Execute_GetID(Node));
+	}
+	if (Components->Num() < 1) return;
+
+	if (!FlushNetworkUpdatesHandle.IsValid()) FlushNetworkUpdatesHandle = FCoreDelegates::OnEndFrame.AddStatic(&UFINNetworkCircuit::FlushNetworkUpdates);
+	
+	for (UObject* Node : Nodes) {
+		if (Node) QueuedNetworkUpdates.FindOrAdd(Node).Add(FFINQueuedNetworkUpdate{Type, Components});
+	}
+}
+
+void UFINNetworkCircuit::FlushNetworkUpdates() {
+	if (QueuedNetworkUpdates.Num() < 1) return;
+	
+	// updates caused by the notifications get delivered next frame
+	TMap<TWeakObjectPtr<UObject>, TArray<FFINQueuedNetworkUpdate>> Updates = MoveTemp(QueuedNetworkUpdates);
+	QueuedNetworkUpdates.Reset();
+	
+	for (const TPair<TWeakObjectPtr<UObject>, TArray<FFINQueuedNetworkUpdate>>& NodeUpdates : Updates) {
+		UObject* Node = NodeUpdates.Key.Get();
+		if (!Node) continue;
+
+		// a single update can get delivered with the shared ids
+		if (NodeUpdates.Value.Num() == 1) {
+			const FFINQueuedNetworkUpdate& Update = NodeUpdates.Value[0];
+			IFINNetworkCircuitNode::Execute_NotifyNetworkUpdate(Node, Update.Type, *Update.Components);
+			continue;
+		}
+		
+		TSet<FGuid> Changes[2];
+		for (const FFINQueuedNetworkUpdate& Update : NodeUpdates.Value) {
+			for (const FGuid& Component : *Update.Components) {
+				if (Changes[1 - Update.Type].Remove(Component) < 1) Changes[Update.Type].Add(Component);
+			}
+		}
+		for (int32 Type = 0; Type < 2; ++Type) {
+			if (Changes[Type].Num() > 0) IFINNetworkCircuitNode::Execute_NotifyNetworkUpdate(Node, Type, Changes[Type]);
 		}
 	}
 }
@@ -21,6 +172,8 @@ UFINNetworkCircuit::~UFINNetworkCircuit() {}
 UFINNetworkCircuit* UFINNetworkCircuit::operator+(UFINNetworkCircuit* Circuit) {
 	if (this == Circuit || !IsValid(Circuit)) return this;
 
+	FFINNetworkTrace::InvalidateValidityCache();
+
 	UFINNetworkCircuit* From = Circuit;
 	UFINNetworkCircuit* To = this;
 
@@ -34,33 +187,42 @@ UFINNetworkCircuit* UFINNetworkCircuit::operator+(UFINNetworkCircuit* Circuit) {
 		UObject* O = ToNode.Get();
 		if (O) ToNodes.Add(O);
 	}
-	for (const TSoftObjectPtr<UObject>& Node : From->Nodes) {
-		UObject* Obj = Node.Get();
-		if (!Obj) continue;
-		IFINNetworkCircuitNode::Execute_SetCircuit(Obj, To);
-		IFINNetworkCircuitNode::Execute_NotifyNetworkUpdate(Obj, 0, ToNodes);
-	}
-
 	TSet<UObject*> FromNodes;
 	for (const TSoftObjectPtr<UObject>& FromNode : From->Nodes) {
 		UObject* O = FromNode.Get();
-		if (O) FromNodes.Add(O);
-	}
-	for (const TSoftObjectPtr<UObject>& Node : To->Nodes) {
-		UObject* Obj = Node.Get();
-		if (Obj) IFINNetworkCircuitNode::Execute_NotifyNetworkUpdate(Obj, 0, FromNodes);
+		if (!O) continue;
+		FromNodes.Add(O);
+		IFINNetworkCircuitNode::Execute_SetCircuit(O, To);
 	}
 
+	QueueNetworkUpdate(FromNodes, 0, ToNodes);
+	QueueNetworkUpdate(ToNodes, 0, FromNodes);
+
 	To->Nodes.Append(From->Nodes);
+	for (const TSoftObjectPtr<UObject>& Node : From->Nodes) {
+		To->AddToIndex(Node.Get());
+	}
 
 	return To;
 }
 
 void UFINNetworkCircuit::Recalculate(const TScriptInterface<IFINNetworkCircuitNode>& Node) {
+	FFINNetworkTrace::InvalidateValidityCache();
+	
 	Nodes.Empty();
+	{
+		FWriteScopeLock Lock(IndexLock);
+		ComponentsByID.Empty();
+		ComponentsByNickToken.Empty();
+		PortListeners.Empty();
+		IndexedComponents.Empty();
+	}
 
-	TSet<TScriptInterface<IFINNetworkCircuitNode>> Added;
-	AddNodeRecursive(Added, Node);
+	AddConnectedNodes(Node.GetObject());
+}
+
+void UFINNetworkCircuit::UpdateComponent(UObject* Component) {
+	if (Nodes.Contains(Component)) AddToIndex(Component);
 }
 
 bool UFINNetworkCircuit::HasNode(const TScriptInterface<IFINNetworkCircuitNode>& Node) {
@@ -69,27 +231,61 @@ bool UFINNetworkCircuit::HasNode(const TScriptInterface<IFINNetworkCircuitNode>&
 
 TScriptInterface<IFINNetworkComponent> UFINNetworkCircuit::FindComponent(const FGuid& ID, const TScriptInterface<IFINNetworkComponent>& Requester) {
 	FGuid ReqID = (Requester) ? IFINNetworkComponent::Execute_GetID(Requester.GetObject()) : FGuid();
-	for (const TSoftObjectPtr<UObject>& node : Nodes) {
-		UObject* Obj = node.Get();
-		if (Obj && Obj->Implements<UFINNetworkComponent>() && IFINNetworkComponent::Execute_GetID(Obj) == ID && IFINNetworkComponent::Execute_AccessPermitted(Obj, ReqID)) {
+	TArray<TWeakObjectPtr<UObject>, TInlineAllocator<4>> Candidates;
+	{
+		FReadScopeLock Lock(IndexLock);
+		ComponentsByID.MultiFind(ID, Candidates);
+	}
+	for (const TWeakObjectPtr<UObject>& Candidate : Candidates) {
+		UObject* Obj = Candidate.Get();
+		if (Obj && IFINNetworkComponent::Execute_GetID(Obj) == ID && IFINNetworkComponent::Execute_AccessPermitted(Obj, ReqID)) {
 			return Obj;
 		}
 	}
-
 	return nullptr;
 }
 
 TSet<UObject*> UFINNetworkCircuit::FindComponentsByNick(const FString& Nick, const TScriptInterface<IFINNetworkComponent>& Requester) {
 	FGuid ReqID = (Requester) ? IFINNetworkComponent::Execute_GetID(Requester.GetObject()) : FGuid();
 	TSet<UObject*> Comps;
-	for (const TSoftObjectPtr<UObject>& Node : Nodes) {
-		UObject* Obj = Node.Get();
-		if (Obj && Obj->Implements<UFINNetworkComponent>() && IFINNetworkComponent::Execute_HasNick(Obj, Nick) && IFINNetworkComponent::Execute_AccessPermitted(Obj, ReqID)) Comps.Add(Obj);
+
+	// a query without tokens matches every component
+	TArray<FString> Tokens = GetNickTokens(Nick);
+	if (Tokens.Num() < 1) {
+		for (const TSoftObjectPtr<UObject>& Node : Nodes) {
+			UObject* Obj = Node.Get();
+			if (Obj && Obj->Implements<UFINNetworkComponent>() && IFINNetworkComponent::Execute_AccessPermitted(Obj, ReqID)) Comps.Add(Obj);
+		}
+		return Comps;
+	}
+
+	// only components having the rarest token of the query can match
+	TArray<TWeakObjectPtr<UObject>> Candidates;
+	{
+		FReadScopeLock Lock(IndexLock);
+		const TSet<TWeakObjectPtr<UObject>>* Rarest = nullptr;
+		for (const FString& Token : Tokens) {
+			const TSet<TWeakObjectPtr<UObject>>* Components = ComponentsByNickToken.Find(Token);
+			if (!Components) return Comps;
+			if (!Rarest || Components->Num() < Rarest->Num()) Rarest = Components;
+		}
+		Candidates = Rarest->Array();
+	}
+	for (const TWeakObjectPtr<UObject>& Candidate : Candidates) {
+		UObject* Obj = Candidate.Get();
+		if (Obj && IFINNetworkComponent::Execute_HasNick(Obj, Nick) && IFINNetworkComponent::Execute_AccessPermitted(Obj, ReqID)) Comps.Add(Obj);
 	}
 
 	return Comps;
 }
 
+TArray<TWeakObjectPtr<UObject>> UFINNetworkCircuit::GetPortListeners(int Port) const {
+	FReadScopeLock Lock(IndexLock);
+	const TSet<TWeakObjectPtr<UObject>>* Listeners = PortListeners.Find(Port);
+	if (!Listeners) return TArray<TWeakObjectPtr<UObject>>();
+	return Listeners->Array();
+}
+
 TSet<UObject*> UFINNetworkCircuit::GetComponents() {
 	TSet<UObject*> Comps;
 	for (const TSoftObjectPtr<UObject>& Node : Nodes) {
@@ -100,72 +296,53 @@ TSet<UObject*> UFINNetworkCircuit::GetComponents() {
 }
 
 bool UFINNetworkCircuit::IsNodeConnected(const TScriptInterface<IFINNetworkCircuitNode>& Start, const TScriptInterface<IFINNetworkCircuitNode>& Node) {
-	TSet<UObject*> Searched;
-	return IsNodeConnected_Internal(Start, Node, Searched);
+	if (!Start.GetObject() || !Node.GetObject()) return false;
+	TSet<UObject*> Side;
+	return Start.GetObject() == Node.GetObject() || !FindSmallerSide(Start.GetObject(), Node.GetObject(), Side);
 }
 
 void UFINNetworkCircuit::DisconnectNodes(const TScriptInterface<IFINNetworkCircuitNode>& A, const TScriptInterface<IFINNetworkCircuitNode>& B) {
-	if (!IsNodeConnected(A, B)) {
-		UFINNetworkCircuit* CircuitA = IFINNetworkCircuitNode::Execute_GetCircuit(A.GetObject());
-		UFINNetworkCircuit* CircuitB = IFINNetworkCircuitNode::Execute_GetCircuit(B.GetObject());
-		if (CircuitA != CircuitB) return;
-		
-		CircuitA = NewObject<UFINNetworkCircuit>();
-		IFINNetworkCircuitNode::Execute_SetCircuit(A.GetObject(), CircuitA);
-		CircuitA->Recalculate(A);
+	UFINNetworkCircuit* Circuit = IFINNetworkCircuitNode::Execute_GetCircuit(A.GetObject());
+	if (!Circuit || Circuit != IFINNetworkCircuitNode::Execute_GetCircuit(B.GetObject())) return;
 
-		
-		TSet<UObject*> NodesA;
-		for (const TSoftObjectPtr<UObject>& Node : CircuitA->Nodes) {
-			UObject* Obj = Node.Get();
-			if (Obj) NodesA.Add(Obj);
-		}
-		TSet<UObject*> NodesB;
-		for (const TSoftObjectPtr<UObject>& Node : CircuitB->Nodes) {
-			UObject* Obj = Node.Get();
-			if (Obj) NodesB.Add(Obj);
-		}
+	// only the nodes of the smaller side get traversed and moved to a new circuit
+	TSet<UObject*> Moved;
+	if (!FindSmallerSide(A.GetObject(), B.GetObject(), Moved)) return;
 
-		for (const TSoftObjectPtr<UObject>& Node : CircuitB->Nodes) {
-			if (CircuitB->Nodes.Contains(Node)) continue;
-			IFINNetworkCircuitNode::Execute_NotifyNetworkUpdate(Node.Get(), 1, NodesA);
-		}
-		CircuitB->Recalculate(B);
-		for (const TSoftObjectPtr<UObject>& Node : CircuitA->Nodes) {
-			if (CircuitA->Nodes.Contains(Node)) continue;
-			IFINNetworkCircuitNode::Execute_NotifyNetworkUpdate(Node.Get(), 1, NodesB);
-		}
+	FFINNetworkTrace::InvalidateValidityCache();
+
+	UFINNetworkCircuit* NewCircuit = NewObject<UFINNetworkCircuit>();
+	for (UObject* Node : Moved) {
+		Circuit->RemoveNode(Node);
+		NewCircuit->AddNode(Node);
 	}
+
+	TSet<UObject*> Remaining;
+	for (const TSoftObjectPtr<UObject>& Node : Circuit->Nodes) {
+		UObject* Obj = Node.Get();
+		if (Obj) Remaining.Add(Obj);
+	}
+	QueueNetworkUpdate(Moved, 1, Remaining);
+	QueueNetworkUpdate(Remaining, 1, Moved);
 }
 
 void UFINNetworkCircuit::ConnectNodes(const TScriptInterface<IFINNetworkCircuitNode>& A, const TScriptInterface<IFINNetworkCircuitNode>& B) {
+	// nodes without a circuit get a fresh one containing only the nodes which don't belong to a circuit yet,
+	// so connecting new nodes to a network doesn't recalculate the whole network
 	UFINNetworkCircuit* CircuitA = IFINNetworkCircuitNode::Execute_GetCircuit(A.GetObject());
+	if (!CircuitA) {
+		CircuitA = NewObject<UFINNetworkCircuit>();
+		CircuitA->AddConnectedNodes(A.GetObject(), true);
+	}
 	UFINNetworkCircuit* CircuitB = IFINNetworkCircuitNode::Execute_GetCircuit(B.GetObject());
 	if (!CircuitB) {
 		CircuitB = NewObject<UFINNetworkCircuit>();
-		IFINNetworkCircuitNode::Execute_SetCircuit(B.GetObject(), CircuitB);
-		CircuitB->Recalculate(B);
+		CircuitB->AddConnectedNodes(B.GetObject(), true);
 	}
-	if (CircuitA) {
-		if (CircuitA != CircuitB) {
-			IFINNetworkCircuitNode::Execute_SetCircuit(A.GetObject(), CircuitA = *CircuitA + CircuitB);
-			IFINNetworkCircuitNode::Execute_SetCircuit(B.GetObject(), CircuitA);
-		}
-	} else {
-		IFINNetworkCircuitNode::Execute_SetCircuit(A.GetObject(), CircuitB);
-		CircuitB->Recalculate(A);
+	if (CircuitA != CircuitB) {
+		// the smaller circuit gets merged into the larger one
+		UFINNetworkCircuit* Circuit = *CircuitA + CircuitB;
+		IFINNetworkCircuitNode::Execute_SetCircuit(A.GetObject(), Circuit);
+		IFINNetworkCircuitNode::Execute_SetCircuit(B.GetObject(), Circuit);
 	}
 }
-
-bool UFINNetworkCircuit::IsNodeConnected_Internal(const TScriptInterface<IFINNetworkCircuitNode>& Self, const TScriptInterface<IFINNetworkCircuitNode>& Node, TSet<UObject*>& Searched) {
-	if (Searched.Contains(Self.GetObject())) return false;
-	Searched.Add(Self.GetObject());
-
-	if (Self == Node) return true;
-	
-	for (TScriptInterface<IFINNetworkCircuitNode> Connected : IFINNetworkCircuitNode::Execute_GetConnected(Self.GetObject())) {
-		if (IsNodeConnected_Internal(Connected, Node, Searched)) return true;
-	}
-
-	return false;
-}
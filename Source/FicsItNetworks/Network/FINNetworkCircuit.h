@@ -4,10 +4,30 @@
 #include "FINNetworkCircuitNode.h"
 #include "FINNetworkComponent.h"
 #include "Network/FINNetworkTrace.h"
+#include "Misc/ScopeRWLock.h"
 #include "FINNetworkCircuit.generated.h"
 
 class UFINAdvancedNetworkConnectionComponent;
 
+/**
+ * The ID, nick tokens and open ports a node got indexed with by a circuit.
+ * Used to remove the node from the indices again.
+ */
+struct FFINCircuitIndexEntry {
+	FGuid ID;
+	TArray<FString> NickTokens;
+	TArray<int> Ports;
+};
+
+/**
+ * A network update queued for a node.
+ * The ids are shared between all nodes affected by the same change.
+ */
+struct FFINQueuedNetworkUpdate {
+	int32 Type;
+	TSharedRef<const TSet<FGuid>> Components;
+};
+
 /**
  * Manages and caches a computer network circuit.
  * When changes occur in the network, also sends signals to the componentes accordingly.
@@ -21,7 +41,105 @@ class FICSITNETWORKS_API UFINNetworkCircuit : public UObject {
 protected:
 	TSet<TSoftObjectPtr<UObject>> Nodes;
 
-	void AddNodeRecursive(TSet<TScriptInterface<IFINNetworkCircuitNode>>& Added, TScriptInterface<IFINNetworkCircuitNode> Add);
+	/**
+	 * Index of the components in the circuit by their ID.
+	 */
+	TMultiMap<FGuid, TWeakObjectPtr<UObject>> ComponentsByID;
+
+	/**
+	 * Inverted index of the components in the circuit by the tokens of their nick.
+	 */
+	TMap<FString, TSet<TWeakObjectPtr<UObject>>> ComponentsByNickToken;
+
+	/**
+	 * Index of the network message interfaces in the circuit by the ports they have open.
+	 */
+	TMap<int, TSet<TWeakObjectPtr<UObject>>> PortListeners;
+
+	/**
+	 * The index entries of all indexed components.
+	 */
+	TMap<TWeakObjectPtr<UObject>, FFINCircuitIndexEntry> IndexedComponents;
+
+	/**
+	 * Guards the ID, nick and port index and the index entries,
+	 * they get queried by the kernels of computers from any thread.
+	 */
+	mutable FRWLock IndexLock;
+
+	/**
+	 * Adds the given node and all nodes connected to it to the circuit.
+	 * Traverses the nodes iteratively, so the size of the network is not limited by the stack.
+	 *
+	 * @param[in]	Start			the node to start the traversal at
+	 * @param[in]	bSkipAssigned	true if nodes which already belong to a circuit should neither get added nor traversed
+	 */
+	void AddConnectedNodes(UObject* Start, bool bSkipAssigned = false);
+
+	/**
+	 * Adds the given node to the circuit and index and sets the circuit of the node.
+	 */
+	void AddNode(UObject* Node);
+
+	/**
+	 * Removes the given node from the circuit and index.
+	 */
+	void RemoveNode(UObject* Node);
+
+	/**
+	 * Traverses the nodes connected to A and B side by side until one side runs out of nodes
+	 * or the sides meet each other.
+	 * So the cost only depends on the size of the smaller side.
+	 *
+	 * @param[in]	A		the first node
+	 * @param[in]	B		the second node
+	 * @param[out]	OutSide	the nodes of the smaller side, if A and B are not connected
+	 * @return	true if A and B are not connected
+	 */
+	static bool FindSmallerSide(UObject* A, UObject* B, TSet<UObject*>& OutSide);
+
+	/**
+	 * Adds the given node to the ID and nick index if it is a network component
+	 * and to the port index if it is a network message interface.
+	 */
+	void AddToIndex(UObject* Node);
+
+	/**
+	 * Removes the given node from the ID, nick and port index.
+	 */
+	void RemoveFromIndex(UObject* Node);
+
+	/**
+	 * Removes the given node from the ID, nick and port index, the index lock has to be write locked by the caller.
+	 */
+	void RemoveFromIndexInternal(UObject* Node);
+
+	/**
+	 * Splits the given nick into its tokens.
+	 */
+	static TArray<FString> GetNickTokens(const FString& Nick);
+
+private:
+	static TMap<TWeakObjectPtr<UObject>, TArray<FFINQueuedNetworkUpdate>> QueuedNetworkUpdates;
+	static FDelegateHandle FlushNetworkUpdatesHandle;
+
+	/**
+	 * Queues a network update for the given nodes, telling them the given nodes got added or removed.
+	 * Only the ids of the changed nodes which are network components get collected (once for all nodes).
+	 *
+	 * @param[in]	Nodes	the nodes which should get notified
+	 * @param[in]	Type	0 if the changed nodes got added, 1 if they got removed
+	 * @param[in]	Changed	the nodes which got added or removed
+	 */
+	static void QueueNetworkUpdate(const TSet<UObject*>& Nodes, int32 Type, const TSet<UObject*>& Changed);
+
+	/**
+	 * Delivers all queued network updates.
+	 * Each node gets one update per type containing all changes of the frame,
+	 * adding and removing the same component in one frame cancels out.
+	 * Gets called at the end of every frame.
+	 */
+	static void FlushNetworkUpdates();
 
 public:
 	UFINNetworkCircuit();
@@ -38,6 +156,16 @@ public:
 	 */
 	void Recalculate(const TScriptInterface<IFINNetworkCircuitNode>& Node);
 
+	/**
+	 * Updates the ID, nick and port index entry of the given component.
+	 * Has to get called by components after their ID, nick or open ports changed,
+	 * otherwise lookups by ID, nick or port still use the old values.
+	 *
+	 * @param[in]	Component	the component which changed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Network|Circuit")
+	void UpdateComponent(UObject* Component);
+
 	/**
 	 * Returns if the given node is part of the circuit based on the circuit cache
 	 */
@@ -63,6 +191,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Network|Circuit")
 	TSet<UObject*> FindComponentsByNick(const FString& Nick, const TScriptInterface<IFINNetworkComponent>& Requester);
 
+	/**
+	 * Returns the network message interfaces in the circuit listening on the given port.
+	 *
+	 * @param[in]	Port	the port you want to get the listeners of
+	 * @return	a copy of the listeners of the port, empty if nobody listens on the port
+	 */
+	TArray<TWeakObjectPtr<UObject>> GetPortListeners(int Port) const;
+
 	/**
 	 * Returns all components in the circuit cache.
 	 */
@@ -98,7 +234,4 @@ public:
 	 */
 	UFUNCTION()
 	static void ConnectNodes(const TScriptInterface<IFINNetworkCircuitNode>& A, const TScriptInterface<IFINNetworkCircuitNode>& B);
-
-private:
-	static bool IsNodeConnected_Internal(const TScriptInterface<IFINNetworkCircuitNode>& Self, const TScriptInterface<IFINNetworkCircuitNode>& Node, TSet<UObject*>& Searched);
 };
\ No newline at end of file
@@ -43,7 +43,11 @@ public:
 	/**
 	* This functions gets executed when a change in the computer network circuit occured.
 	* Like adding or removing a new node.
+	* Changes get collected and delivered once per frame, so every node gets at most one update per type and frame.
+	*
+	* @param[in]	Type		0 if the components got added, 1 if they got removed
+	* @param[in]	Components	the ids of the added or removed components
 	*/
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Network|Component")
-    void NotifyNetworkUpdate(int32 Type, const TSet<UObject*>& Nodes);
+    void NotifyNetworkUpdate(int32 Type, const TSet<FGuid>& Components);
 };
\ No newline at end of file
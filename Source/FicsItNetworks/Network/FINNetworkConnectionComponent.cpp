@@ -24,7 +24,7 @@ void UFINNetworkConnectionComponent::SetCircuit_Implementation(UFINNetworkCircui
 	this->Circuit = Circuit;
 }
 
-void UFINNetworkConnectionComponent::NotifyNetworkUpdate_Implementation(int Type, const TSet<UObject*>& Nodes) {}
+void UFINNetworkConnectionComponent::NotifyNetworkUpdate_Implementation(int Type, const TSet<FGuid>& Components) {}
 
 void UFINNetworkConnectionComponent::AddConnectedNode(TScriptInterface<IFINNetworkCircuitNode> Node) {
 	if (ConnectedNodes.Contains(Node.GetObject())) return;
@@ -45,7 +45,7 @@ public:
 	virtual TSet<UObject*> GetConnected_Implementation() const override;
 	virtual UFINNetworkCircuit* GetCircuit_Implementation() const override;
 	virtual void SetCircuit_Implementation(UFINNetworkCircuit* Circuit) override;
-	virtual void NotifyNetworkUpdate_Implementation(int Type, const TSet<UObject*>& Nodes) override;
+	virtual void NotifyNetworkUpdate_Implementation(int Type, const TSet<FGuid>& Components) override;
 	// End IFINNetworkCircuitNode
 
 	/**
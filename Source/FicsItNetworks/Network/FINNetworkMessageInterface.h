@@ -24,14 +24,25 @@ public:
 	 */
 	virtual bool IsPortOpen(int Port) { return false; };
 
+	/**
+	 * Returns all ports the message interface is listening on.
+	 * Used by the circuit to index the listeners of the ports.
+	 *
+	 * @return	the open ports
+	 */
+	virtual TSet<int> GetOpenPorts() { return TSet<int>(); };
+
 	/**
 	 * Lets the network message implemnter handle internally a new message
 	 * on the given port.
 	 * Doesn't need to apply port filtering.
+	 * May refuse the message f.e. if the implementer is not able to take any more messages,
+	 * so the sender can react to it (backpressure).
 	 *
 	 * @param[in]	Sender	Network Trace pointing from this to the sender
 	 * @param[in]	Port	The port on which the message got sent
 	 * @param[in]	Data	The data frame of the message
+	 * @return	true if the message got accepted
 	 */
-	virtual void HandleMessage(FFINNetworkTrace Sender, int Port, const TFINDynamicStruct<FFINParameterList>& Data) {};
+	virtual bool HandleMessage(FFINNetworkTrace Sender, int Port, const TFINDynamicStruct<FFINParameterList>& Data) { return false; };
 };
\ No newline at end of file
@@ -17,6 +17,8 @@
 #include "Network/FINNetworkCircuit.h"
 #include "util/Logging.h"
 
+#include "Misc/ScopeRWLock.h"
+
 #define StepFuncName(A, B) Step ## _ ## A ## _ ## B
 #define StepRegName(A, B) StepReg ## _ ## A ## _ ## B
 #define StepRegSigName(A, B) StepRegSig ## _ ## A ## _ ## B
@@ -50,6 +52,14 @@ TMap<FString, TSharedPtr<FFINTraceStep>> FFINNetworkTrace::traceStepRegistry;
 TMap<TSharedPtr<FFINTraceStep>, FString> FFINNetworkTrace::inverseTraceStepRegistry;
 TMap<UClass*, TPair<TMap<UClass*, TSharedPtr<FFINTraceStep>>, TMap<UClass*, TSharedPtr<FFINTraceStep>>>> FFINNetworkTrace::traceStepMap;
 TMap<UClass*, TPair<TMap<UClass*, TSharedPtr<FFINTraceStep>>, TMap<UClass*, TSharedPtr<FFINTraceStep>>>> FFINNetworkTrace::interfaceTraceStepMap;
+TArray<TSharedPtr<FFINTraceStep>> FFINNetworkTrace::traceSteps;
+std::atomic<uint32> FFINNetworkTrace::ValidityEpoch{1};
+
+/**
+ * Cache of the resolved step ids for all class pairs findTraceStep got called with.
+ */
+TMap<TPair<UClass*, UClass*>, int32> traceStepCache;
+FRWLock traceStepCacheLock;
 
 class FFINTraceStepRegisterer {
 public:
@@ -72,6 +82,7 @@ void traceRegisterSteps() {
 		if (B->GetSuperClass() == UInterface::StaticClass()) BMap = &(*AMap).FindOrAdd(A).Value;
 		else BMap = &(*AMap).FindOrAdd(A).Key;
 		TSharedPtr<FFINTraceStep> stepPtr = TSharedPtr<FFINTraceStep>(tStep);
+		FFINNetworkTrace::traceSteps.Add(stepPtr);
 		(*BMap).FindOrAdd(B) = stepPtr;
 		FFINNetworkTrace::traceStepRegistry.FindOrAdd(step.Value.Key) = stepPtr;
 		FFINNetworkTrace::inverseTraceStepRegistry.FindOrAdd(stepPtr) = step.Value.Key;
@@ -79,6 +90,14 @@ void traceRegisterSteps() {
 	FFINNetworkTrace::toRegister.Empty();
 };
 
+/**
+ * Registers all trace steps the first time it gets called.
+ * Thread safe.
+ */
+void traceEnsureStepsRegistered() {
+	static bool registered = (traceRegisterSteps(), true);
+}
+
 TSharedPtr<FFINTraceStep> findTraceStep2(TPair<TMap<UClass*, TSharedPtr<FFINTraceStep>>, TMap<UClass*, TSharedPtr<FFINTraceStep>>>& stepList, UClass* B) {
 	UClass* Bi = B;
 	while (Bi && Bi != UObject::StaticClass()) {
@@ -99,11 +118,10 @@ TSharedPtr<FFINTraceStep> findTraceStep2(TPair<TMap<UClass*, TSharedPtr<FFINTrac
 	return nullptr;
 }
 
-TSharedPtr<FFINTraceStep> FFINNetworkTrace::findTraceStep(UClass* A, UClass* B) {
-	if (!A || !B) return fallbackTraceStep;
+TSharedPtr<FFINTraceStep> traceResolveStep(UClass* A, UClass* B) {
 	UClass* Ai = A;
 	while (Ai && Ai != UObject::StaticClass()) {
-		auto stepA = traceStepMap.Find(Ai);
+		auto stepA = FFINNetworkTrace::traceStepMap.Find(Ai);
 		if (stepA) {
 			TSharedPtr<FFINTraceStep> step = findTraceStep2(*stepA, B);
 			if (step.IsValid()) return step;
@@ -112,73 +130,131 @@ TSharedPtr<FFINTraceStep> FFINNetworkTrace::findTraceStep(UClass* A, UClass* B)
 	}
 	
 	for (FImplementedInterface& interface : A->Interfaces) {
-		auto stepA = interfaceTraceStepMap.Find(interface.Class);
+		auto stepA = FFINNetworkTrace::interfaceTraceStepMap.Find(interface.Class);
 		if (stepA) {
 			TSharedPtr<FFINTraceStep> step = findTraceStep2(*stepA, B);
 			if (step.IsValid()) return step;
 		}
 	}
 
-	return fallbackTraceStep;
+	return nullptr;
+}
+
+TSharedPtr<FFINTraceStep> FFINNetworkTrace::getTraceStep(int32 StepId) {
+	if (StepId < 1 || StepId > traceSteps.Num()) return fallbackTraceStep;
+	return traceSteps[StepId-1];
 }
 
-FFINNetworkTrace::FFINNetworkTrace(const FFINNetworkTrace& trace) {
-	traceRegisterSteps();
+int32 FFINNetworkTrace::findTraceStepId(UClass* A, UClass* B) {
+	traceEnsureStepsRegistered();
+	if (!A || !B) return 0;
+
+	TPair<UClass*, UClass*> Key(A, B);
+	{
+		FReadScopeLock Lock(traceStepCacheLock);
+		const int32* StepId = traceStepCache.Find(Key);
+		if (StepId) return *StepId;
+	}
+
+	TSharedPtr<FFINTraceStep> Step = traceResolveStep(A, B);
+	int32 StepId = Step.IsValid() ? traceSteps.IndexOfByKey(Step) + 1 : 0;
 	
-	Prev = MakeShareable((trace.Prev) ? new FFINNetworkTrace(*trace.Prev) : nullptr);
-	Step = trace.Step;
-	Obj = trace.Obj;
+	FWriteScopeLock Lock(traceStepCacheLock);
+	traceStepCache.Add(Key, StepId);
+	return StepId;
 }
 
-FFINNetworkTrace& FFINNetworkTrace::operator=(const FFINNetworkTrace& trace) {
-	Prev = MakeShareable((trace.Prev) ? new FFINNetworkTrace(*trace.Prev) : nullptr);
-	Step = trace.Step;
-	Obj = trace.Obj;
+TSharedPtr<FFINTraceStep> FFINNetworkTrace::findTraceStep(UClass* A, UClass* B) {
+	return getTraceStep(findTraceStepId(A, B));
+}
 
-	return *this;
+void FFINNetworkTrace::InvalidateValidityCache() {
+	++ValidityEpoch;
 }
 
-FFINNetworkTrace::FFINNetworkTrace() : FFINNetworkTrace(nullptr) {
-	traceRegisterSteps();
+FFINNetworkTrace::FFINNetworkTrace(TArray<FFINTraceEntry>&& Entries) {
+	TSharedPtr<FFINTraceData, ESPMode::ThreadSafe> NewData = MakeShared<FFINTraceData, ESPMode::ThreadSafe>();
+	NewData->Entries = MoveTemp(Entries);
+	Data = NewData;
 }
 
-FFINNetworkTrace::FFINNetworkTrace(UObject* Obj) : Obj(Obj) {
-	traceRegisterSteps();
+FFINNetworkTrace::FFINNetworkTrace() {}
+
+FFINNetworkTrace::FFINNetworkTrace(UObject* Obj) {
+	if (Obj) *this = FFINNetworkTrace(TArray<FFINTraceEntry>{FFINTraceEntry{Obj, nullptr}});
 }
 
 FFINNetworkTrace::~FFINNetworkTrace() {}
 
+const FFINTraceEntry* FFINNetworkTrace::GetLast() const {
+	if (!Data || Data->Entries.Num() < 1) return nullptr;
+	return &Data->Entries.Last();
+}
+
+void traceSaveEntry(FArchive& Ar, const TArray<FFINTraceEntry>& Entries, int32 Index) {
+	UObject* ptr = (Index >= 0) ? Entries[Index].Obj.Get() : nullptr;
+	bool valid = ptr != nullptr;
+	Ar << valid;
+	if (!valid) return;
+	
+	// obj ptr
+	Ar << ptr;
+	
+	// prev trace
+	bool hasPrev = Index > 0;
+	Ar << hasPrev;
+	if (hasPrev) traceSaveEntry(Ar, Entries, Index - 1);
+
+	// step
+	FString* save = Entries[Index].Step.IsValid() ? FFINNetworkTrace::inverseTraceStepRegistry.Find(Entries[Index].Step) : nullptr;
+	bool hasStep = save != nullptr;
+	Ar << hasStep;
+	if (hasStep) Ar << *save;
+}
+
+void traceLoadEntry(FArchive& Ar, TArray<FFINTraceEntry>& Entries) {
+	bool valid = false;
+	Ar << valid;
+	if (!valid) {
+		// an unreachable hop makes the whole trace invalid
+		Entries.Add(FFINTraceEntry{nullptr, nullptr});
+		return;
+	}
+
+	// obj ptr
+	UObject* ptr = nullptr;
+	Ar << ptr;
+
+	// prev trace
+	bool hasPrev = false;
+	Ar << hasPrev;
+	if (hasPrev) traceLoadEntry(Ar, Entries);
+
+	// step
+	TSharedPtr<FFINTraceStep> step;
+	bool hasStep = false;
+	Ar << hasStep;
+	if (hasStep) {
+		FString save;
+		Ar << save;
+		TSharedPtr<FFINTraceStep>* found = FFINNetworkTrace::traceStepRegistry.Find(save);
+		if (found) step = *found;
+	}
+	Entries.Add(FFINTraceEntry{ptr, step});
+}
+
 bool FFINNetworkTrace::Serialize(FArchive& Ar) {
 	if (Ar.IsSaveGame()) {
-		bool valid = GetUnderlyingPtr().IsValid();
-		Ar << valid;
-		if (valid) {
-			// obj ptr
-			UObject* ptr = GetUnderlyingPtr().Get();
-			Ar << ptr;
-			Obj = ptr;
-	
-			// prev trace
-			bool hasPrev = Prev.IsValid();
-			Ar << hasPrev;
-			if (hasPrev) {
-				FFINNetworkTrace prev;
-				if (Ar.IsSaving()) prev = *Prev;
-				Ar << prev;
-				if (Ar.IsLoading()) {
-					Prev = MakeShared<FFINNetworkTrace>(prev);
-				}
-			}
-
-			// step
-			bool hasStep = Step.Get();
-			Ar << hasStep;
-			if (hasStep) {
-				FString save;
-				if (Ar.IsSaving()) save = inverseTraceStepRegistry[Step];
-				Ar << save;
-				if (Ar.IsLoading()) Step = traceStepRegistry[TCHAR_TO_UTF8(*save)];
-			}
+		traceEnsureStepsRegistered();
+		if (Ar.IsSaving()) {
+			static const TArray<FFINTraceEntry> NoEntries;
+			const TArray<FFINTraceEntry>& Entries = Data ? Data->Entries : NoEntries;
+			traceSaveEntry(Ar, Entries, Entries.Num() - 1);
+		} else {
+			TArray<FFINTraceEntry> Entries;
+			traceLoadEntry(Ar, Entries);
+			if (Entries.Num() == 1 && !Entries[0].Obj.IsValid()) Data = nullptr;
+			else *this = FFINNetworkTrace(MoveTemp(Entries));
 		}
 	}
 	
@@ -186,26 +262,33 @@ bool FFINNetworkTrace::Serialize(FArchive& Ar) {
 }
 
 FFINNetworkTrace FFINNetworkTrace::operator/(UObject* other) const {
-	FFINNetworkTrace trace(other);
-
-	UObject* A = Obj.Get();
+	const FFINTraceEntry* Last = GetLast();
+	UObject* A = Last ? Last->Obj.Get() : nullptr;
 	if (!A || !other) return FFINNetworkTrace(nullptr); // if A is not valid, the network trace will always be not invalid
-	trace.Prev = MakeShared<FFINNetworkTrace>(*this);
-	trace.Step = findTraceStep(A->GetClass(), other->GetClass());
-	return trace;
+
+	TArray<FFINTraceEntry> Entries;
+	Entries.Reserve(Data->Entries.Num() + 1);
+	Entries.Append(Data->Entries);
+	Entries.Add(FFINTraceEntry{other, findTraceStep(A->GetClass(), other->GetClass())});
+	return FFINNetworkTrace(MoveTemp(Entries));
 }
 
 FFINNetworkTrace FFINNetworkTrace::operator/(FFINObjTraceStepPtr other) {
-	FFINNetworkTrace trace(other.Key);
-	trace.Prev = MakeShared<FFINNetworkTrace>(*this);
-	trace.Step = other.Value;
-	return trace;
+	TArray<FFINTraceEntry> Entries;
+	if (Data) {
+		Entries.Reserve(Data->Entries.Num() + 1);
+		Entries.Append(Data->Entries);
+	} else {
+		// appending to a empty trace results in a trace which is always invalid
+		Entries.Add(FFINTraceEntry{nullptr, nullptr});
+	}
+	Entries.Add(FFINTraceEntry{other.Key, other.Value});
+	return FFINNetworkTrace(MoveTemp(Entries));
 }
 
 UObject* FFINNetworkTrace::operator*() const {
-	UObject* B = Obj.Get();
-	if (IsValid() && B) {
-		return B;
+	if (IsValid()) {
+		return GetLast()->Obj.Get();
 	} else {
 		return nullptr;
 	}
@@ -217,21 +300,17 @@ UObject* FFINNetworkTrace::operator->() const {
 
 FFINNetworkTrace FFINNetworkTrace::operator()(UObject* other) const {
 	if (!other) return FFINNetworkTrace(nullptr);
+	if (!Data || Data->Entries.Num() < 2) return FFINNetworkTrace(other);
 
-	FFINNetworkTrace trace(*this);
-	trace.Obj = other;
-	
-	if (trace.Prev) {
-		auto A = trace.Prev->Obj.Get();
-		if (!A) return FFINNetworkTrace(nullptr); // if the previous network trace object is invalid, the trace will be always invalid
-		trace.Step = findTraceStep(trace.Prev->Obj->GetClass(), other->GetClass());
-	}
-
-	return trace;
+	TArray<FFINTraceEntry> Entries = Data->Entries;
+	UObject* A = Entries[Entries.Num() - 2].Obj.Get();
+	if (!A) return FFINNetworkTrace(nullptr); // if the previous network trace object is invalid, the trace will be always invalid
+	Entries.Last() = FFINTraceEntry{other, findTraceStep(A->GetClass(), other->GetClass())};
+	return FFINNetworkTrace(MoveTemp(Entries));
 }
 
 bool FFINNetworkTrace::operator==(const FFINNetworkTrace& other) const {
-	return Obj == other.Obj;
+	return GetUnderlyingPtr() == other.GetUnderlyingPtr();
 }
 
 void FFINNetworkTrace::CheckTrace() const {
@@ -239,31 +318,52 @@ void FFINNetworkTrace::CheckTrace() const {
 }
 
 FFINNetworkTrace FFINNetworkTrace::Reverse() const {
-	if (!Obj.IsValid()) return FFINNetworkTrace(nullptr);
-	FFINNetworkTrace trace(Obj.Get());
-	TSharedPtr<FFINNetworkTrace> prev = this->Prev;
-	while (prev) {
-		trace = trace / prev->Obj.Get();
-		prev = prev->Prev;
+	const FFINTraceEntry* Last = GetLast();
+	if (!Last || !Last->Obj.IsValid()) return FFINNetworkTrace(nullptr);
+	
+	const TArray<FFINTraceEntry>& Entries = Data->Entries;
+	TArray<FFINTraceEntry> Reversed;
+	Reversed.Reserve(Entries.Num());
+	UObject* A = Last->Obj.Get();
+	Reversed.Add(FFINTraceEntry{A, nullptr});
+	for (int32 i = Entries.Num() - 2; i >= 0; --i) {
+		UObject* B = Entries[i].Obj.Get();
+		if (!B) return FFINNetworkTrace(nullptr);
+		Reversed.Add(FFINTraceEntry{B, findTraceStep(A->GetClass(), B->GetClass())});
+		A = B;
 	}
-	return trace;
+	return FFINNetworkTrace(MoveTemp(Reversed));
 }
 
 bool FFINNetworkTrace::IsValid() const {
-	UObject* B = Obj.Get();
-	if (!B) return false;
-	if (Prev && Step) {
-		UObject* A = Prev->Obj.Get();
-		if (!A || !(*Step)(A, B)) return false;
+	if (!Data || Data->Entries.Num() < 1) return false;
+	const TArray<FFINTraceEntry>& Entries = Data->Entries;
+
+	// objects have to be alive, this is cheap and so always gets checked
+	for (const FFINTraceEntry& Entry : Entries) {
+		if (!Entry.Obj.IsValid()) return false;
 	}
-	if (Prev) {
-		return Prev->IsValid();
+	if (Entries.Num() < 2) return true;
+
+	// use the cached step validation if it was made in this frame and epoch
+	uint64 Key = (static_cast<uint64>(static_cast<uint32>(GFrameCounter)) << 32) | (static_cast<uint64>(ValidityEpoch.load(std::memory_order_relaxed) & 0x7FFFFFFF) << 1);
+	uint64 Cached = Data->ValidityCache.load(std::memory_order_relaxed);
+	if ((Cached & ~1ull) == Key) return Cached & 1;
+
+	bool bValid = true;
+	for (int32 i = 1; i < Entries.Num(); ++i) {
+		const TSharedPtr<FFINTraceStep>& Step = Entries[i].Step;
+		if (Step && !(*Step)(Entries[i-1].Obj.Get(), Entries[i].Obj.Get())) {
+			bValid = false;
+			break;
+		}
 	}
-	return true;
+	Data->ValidityCache.store(Key | (bValid ? 1 : 0), std::memory_order_relaxed);
+	return bValid;
 }
 
 bool FFINNetworkTrace::IsEqualObj(const FFINNetworkTrace& other) const {
-	return Obj == other.Obj;
+	return GetUnderlyingPtr() == other.GetUnderlyingPtr();
 }
 
 bool FFINNetworkTrace::operator<(const FFINNetworkTrace& other) const {
@@ -272,14 +372,17 @@ bool FFINNetworkTrace::operator<(const FFINNetworkTrace& other) const {
 		int32		ObjectSerialNumber;
 	};
 
-	TWOP* d1 = (TWOP*)&Obj;
-	TWOP* d2 = (TWOP*)&other.Obj;
+	TWeakObjectPtr<UObject> Obj1 = GetUnderlyingPtr();
+	TWeakObjectPtr<UObject> Obj2 = other.GetUnderlyingPtr();
+	TWOP* d1 = (TWOP*)&Obj1;
+	TWOP* d2 = (TWOP*)&Obj2;
 	if (d1->ObjectIndex < d2->ObjectIndex) return true;
 	else return d1->ObjectSerialNumber < d2->ObjectSerialNumber;
 }
 
 TWeakObjectPtr<UObject> FFINNetworkTrace::GetUnderlyingPtr() const {
-	return Obj;
+	const FFINTraceEntry* Last = GetLast();
+	return Last ? Last->Obj : nullptr;
 }
 
 /* ############### */
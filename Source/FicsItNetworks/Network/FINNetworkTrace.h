@@ -3,6 +3,8 @@
 #include "CoreMinimal.h"
 #include "util/Logging.h"
 
+#include <atomic>
+
 #include "FINNetworkTrace.generated.h"
 
 /**
@@ -20,6 +22,24 @@ inline FFINObjTraceStepPtr ObjTraceStep(UObject* obj, FFINTraceStep step) {
 	return FFINObjTraceStepPtr(obj, MakeShared<FFINTraceStep>(step));
 }
 
+/**
+ * A single hop of a network trace.
+ * Holds the object reached with this hop and the step used to check if it's reachable from the object of the previous hop.
+ */
+struct FFINTraceEntry {
+	TWeakObjectPtr<UObject> Obj;
+	TSharedPtr<FFINTraceStep> Step;
+};
+
+/**
+ * The immutable storage of a network trace shared by all copies of the trace.
+ * Also caches the result of the last validation, tagged with the frame and validity epoch it was made in.
+ */
+struct FFINTraceData {
+	TArray<FFINTraceEntry> Entries;
+	mutable std::atomic<uint64> ValidityCache{0};
+};
+
 /**
  * Tracks the access of a object through the network.
  * Allows a later check if the object is still reachable
@@ -31,9 +51,22 @@ struct FICSITNETWORKS_API FFINNetworkTrace {
 	friend uint32 GetTypeHash(const FFINNetworkTrace&);
 
 private:
-	TSharedPtr<FFINNetworkTrace> Prev = nullptr;
-	TSharedPtr<FFINTraceStep> Step = nullptr;
-	TWeakObjectPtr<UObject> Obj = nullptr;
+	TSharedPtr<const FFINTraceData, ESPMode::ThreadSafe> Data;
+
+	/**
+	 * Global counter invalidating all cached validation results when it changes.
+	 */
+	static std::atomic<uint32> ValidityEpoch;
+
+	/**
+	 * Creates a trace using the given entries as storage.
+	 */
+	explicit FFINNetworkTrace(TArray<FFINTraceEntry>&& Entries);
+
+	/**
+	 * Returns the last entry of the trace, nullptr if the trace is empty.
+	 */
+	const FFINTraceEntry* GetLast() const;
 
 public:
 	static TSharedPtr<FFINTraceStep> fallbackTraceStep;
@@ -44,12 +77,36 @@ public:
 	static TMap<UClass*, TPair<TMap<UClass*, TSharedPtr<FFINTraceStep>>, TMap<UClass*, TSharedPtr<FFINTraceStep>>>> interfaceTraceStepMap;
 
 	/**
-	* Trys to find the most suitable trace step of for both given classes
-	*/
+	 * All registered trace steps, indexed by their step id - 1.
+	 */
+	static TArray<TSharedPtr<FFINTraceStep>> traceSteps;
+
+	/**
+	 * Trys to find the most suitable trace step of for both given classes
+	 */
 	static TSharedPtr<FFINTraceStep> findTraceStep(UClass* A, UClass* B);
-	
-	FFINNetworkTrace(const FFINNetworkTrace& trace);
-	FFINNetworkTrace& operator=(const FFINNetworkTrace& trace);
+
+	/**
+	 * Trys to find the id of the most suitable trace step for both given classes.
+	 * The result gets cached for the class pair, so only the first lookup walks the class hierarchies.
+	 *
+	 * @return the id of the step, 0 if no suitable step was found
+	 */
+	static int32 findTraceStepId(UClass* A, UClass* B);
+
+	/**
+	 * Returns the registered trace step with the given id.
+	 * Returns the fallback step if the id is 0 or not valid.
+	 */
+	static TSharedPtr<FFINTraceStep> getTraceStep(int32 StepId);
+
+	/**
+	 * Invalidates the cached validation results of all traces.
+	 * Has to get called when something changes which may affect the reachability of objects,
+	 * like network circuits getting connected or disconnected.
+	 * Cached results are additionally only used within the frame they got created in.
+	 */
+	static void InvalidateValidityCache();
 
 	explicit FFINNetworkTrace();
 	explicit FFINNetworkTrace(UObject* obj);
@@ -107,8 +164,8 @@ public:
 	FFINNetworkTrace Reverse() const;
 
 	/**
-	 * Executes the step function of it self and cascades the steps of the previous traces.
-	 * If no step is found just does the previous traces.
+	 * Checks if all objects of the trace are still alive and executes the step functions of all hops.
+	 * The result of the step functions gets cached until the validity cache gets invalidated or the frame ends.
 	 */
 	bool IsValid() const;
 
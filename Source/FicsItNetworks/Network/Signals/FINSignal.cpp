@@ -1,12 +1,16 @@
 #include "FINSignal.h"
 
-FFINSignal::FFINSignal(FString Name) : Name(Name) {}
+FFINSignal::FFINSignal(FFINName Name) : Name(Name) {}
 
 bool FFINSignal::Serialize(FArchive& Ar) {
 	Ar << Name;
 	return true;
 }
 
-FString FFINSignal::GetName() const {
+const FString& FFINSignal::GetName() const {
+	return Name.ToString();
+}
+
+FFINName FFINSignal::GetNameId() const {
 	return Name;
 }
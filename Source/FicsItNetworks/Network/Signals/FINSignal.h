@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Network/FINName.h"
 #include "Network/FINValueReader.h"
 #include "FINSignal.generated.h"
 
@@ -14,12 +15,11 @@ struct FICSITNETWORKS_API FFINSignal {
 	GENERATED_BODY()
 	
 private:
-	UPROPERTY()
-	FString Name;
+	FFINName Name;
 
 public:
-	FFINSignal() : Name("NoSignal") {}
-	FFINSignal(FString Name);
+	FFINSignal() : Name(TEXT("NoSignal")) {}
+	FFINSignal(FFINName Name);
 	virtual ~FFINSignal() {}
 
 	bool Serialize(FArchive& Ar);
@@ -33,7 +33,18 @@ public:
 	 */
 	virtual int operator>>(FFINValueReader& reader) const { return 0; };
 
-	FString GetName() const;
+	/**
+	 * Returns the amount of memory in bytes the data of the signal uses additionally to the signal itself.
+	 * Gets charged to the memory of the kernels holding the signal in their queue.
+	 */
+	virtual int64 GetPayloadSize() const { return 0; }
+
+	const FString& GetName() const;
+
+	/**
+	 * Returns the interned name of the signal.
+	 */
+	FFINName GetNameId() const;
 };
 
 template<>
@@ -51,7 +62,7 @@ inline bool operator<<(FArchive& Ar, FFINSignal& Signal) {
 
 struct FFINNoSignal : public FFINSignal {
 public:
-	FFINNoSignal() : FFINSignal("None") {}
+	FFINNoSignal() : FFINSignal(TEXT("None")) {}
 
 	virtual int operator>>(FFINValueReader& reader) const override { return 0; }
 };
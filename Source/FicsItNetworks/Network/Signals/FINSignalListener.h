@@ -7,6 +7,32 @@
 
 #include "FINSignalListener.generated.h"
 
+/**
+ * A listener of a signal sender with the trace passed along with the signals sent to it.
+ */
+struct FFINSignalListenerEntry {
+	/**
+	 * The trace from the sender to the listener
+	 */
+	FFINNetworkTrace Listener;
+
+	/**
+	 * The trace from the listener to the sender, precomputed when the listener subscribed
+	 */
+	FFINNetworkTrace Sender;
+
+	/**
+	 * True if the listener wants consecutive identical signals of hooks to get aggregated
+	 */
+	bool bCoalesce = false;
+};
+
+/**
+ * Immutable list of the listeners of a signal sender.
+ * Gets replaced as whole when the listeners change, so emitters can iterate it without locking or copying.
+ */
+typedef TSharedPtr<const TArray<FFINSignalListenerEntry>, ESPMode::ThreadSafe> FFINSignalListenerSnapshot;
+
 /**
  * Allows the implementer to recieve network signals
  */
@@ -24,6 +50,7 @@ public:
 	*
 	* @param	Signal	the signal you want to handle
 	* @param	Sender	the sender of the signal
+	* @return	false if the signal got dropped, f.e. because the signal queue is full
 	*/
-	virtual void HandleSignal(const TFINDynamicStruct<FFINSignal>& Signal, const FFINNetworkTrace& Sender) = 0;
+	virtual bool HandleSignal(const TFINDynamicStruct<FFINSignal>& Signal, const FFINNetworkTrace& Sender) = 0;
 };
\ No newline at end of file
@@ -6,37 +6,59 @@
 #include "FINStructSignal.h"
 #include "Network/FINDynamicStructHolder.h"
 #include "Network/FINFuncParameterList.h"
+#include "Network/FINFunctionLayout.h"
 #include "UObject/ObjectMacros.h"
 #include "UObject/ScriptMacros.h"
 
+TMap<TWeakObjectPtr<UObject>, FFINSignalListenerSnapshot> UFINSignalUtility::ListenerSnapshots;
+FRWLock UFINSignalUtility::ListenerSnapshotsLock;
+int32 UFINSignalUtility::ListenerSnapshotsPruneCount = 1024;
+
+/**
+ * Sends the given signal to all listeners of the given snapshot.
+ */
+static void BroadcastSignalToListeners(const FFINSignalListenerSnapshot& Listeners, const TFINDynamicStruct<FFINSignal>& Signal) {
+	for (const FFINSignalListenerEntry& Listener : *Listeners) {
+		// TODO: Make sure this cast works and if the underlying object is the reason, remove it
+		IFINSignalListener* Obj = Cast<IFINSignalListener>(*Listener.Listener);
+		if (Obj) Obj->HandleSignal(Signal, Listener.Sender);
+	}
+}
+
 #pragma optimize("", off)
 void execRecieveSignal(UObject* Context, FFrame& Stack, RESULT_DECL) {
-	// get signal name
-	FString signalName = Stack.CurrentNativeFunction->GetName();
-	signalName.RemoveFromStart("netSig_");
-
+	const FFINFunctionLayout& layout = FFINFunctionLayout::Get(Stack.CurrentNativeFunction);
+	FFINSignalListenerSnapshot listeners = UFINSignalUtility::GetListenerSnapshot(Context);
+	if (!listeners) {
+		// nobody listens, only the parameters passed by script code need to get stepped over
+		if (Stack.Code) {
+			void* data = FMemory_Alloca(FMath::Max(layout.ParmsSize, 1));
+			layout.Initialize(data);
+			for (UProperty* p : layout.Params) {
+				std::invoke(&FFrame::Step, Stack, Context, p->ContainerPtrToValuePtr<void>(data));
+			}
+			layout.Destroy(data);
+		}
+		P_FINISH;
+		return;
+	}
+	
 	// allocate signal data storage and copy data
-	void* data = FMemory::Malloc(Stack.CurrentNativeFunction->ParmsSize);
-	Stack.CurrentNativeFunction->InitializeStruct(data);
-	for (auto p = TFieldIterator<UProperty>(Stack.CurrentNativeFunction); p; ++p) {
+	void* data = FMemory::Malloc(layout.ParmsSize, layout.Alignment);
+	layout.Initialize(data);
+	for (UProperty* p : layout.Params) {
 		auto dp = p->ContainerPtrToValuePtr<void>(data);
 		if (Stack.Code) {
 			std::invoke(&FFrame::Step, Stack, Context, dp);
 		} else {
-			Stack.StepExplicitProperty(dp, *p);
+			Stack.StepExplicitProperty(dp, p);
 		}
 	}
 
 	// create signal instance
-	TFINDynamicStruct<FFINSignal> sig =  FFINStructSignal(signalName, FFINFuncParameterList(Stack.CurrentNativeFunction, data));
-
-	TSet<FFINNetworkTrace> listeners = IFINSignalSender::Execute_GetListeners(Context);
+	TFINDynamicStruct<FFINSignal> sig =  FFINStructSignal(layout.Name, FFINFuncParameterList(Stack.CurrentNativeFunction, data));
 
-	for (auto listenerTrace : listeners) {
-		// TODO: Make sure this cast works and if the underlying object is the reason, remove it
-		IFINSignalListener* obj = Cast<IFINSignalListener>(*listenerTrace);
-		if (obj) obj->HandleSignal(sig, listenerTrace.Reverse() / IFINSignalSender::Execute_GetSignalSenderOverride(Context));
-	}
+	BroadcastSignalToListeners(listeners, sig);
 
 	P_FINISH;
 }
@@ -50,3 +72,64 @@ void UFINSignalUtility::SetupSender(UClass* signalSender) {
 		func->FunctionFlags |= FUNC_Native;
 	}
 }
+
+void UFINSignalUtility::BroadcastSignal(UObject* Sender, const TFINDynamicStruct<FFINSignal>& Signal) {
+	FFINSignalListenerSnapshot listeners = GetListenerSnapshot(Sender);
+	if (listeners) BroadcastSignalToListeners(listeners, Signal);
+}
+
+void UFINSignalUtility::AddListener(UObject* Sender, const FFINNetworkTrace& Listener) {
+	IFINSignalSender::Execute_AddListener(Sender, Listener);
+	UpdateListenerSnapshot(Sender);
+}
+
+void UFINSignalUtility::RemoveListener(UObject* Sender, const FFINNetworkTrace& Listener) {
+	IFINSignalSender::Execute_RemoveListener(Sender, Listener);
+	FWriteScopeLock Lock(ListenerSnapshotsLock);
+	FFINSignalListenerSnapshot Snapshot = BuildListenerSnapshot(Sender);
+	// the snapshot gets recreated as empty one if the sender emits again
+	if (Snapshot) ListenerSnapshots.FindOrAdd(Sender) = Snapshot;
+	else ListenerSnapshots.Remove(Sender);
+}
+
+FFINSignalListenerSnapshot UFINSignalUtility::BuildListenerSnapshot(UObject* Sender) {
+	TSet<FFINNetworkTrace> Listeners = IFINSignalSender::Execute_GetListeners(Sender);
+	if (Listeners.Num() < 1) return nullptr;
+	UObject* SenderOverride = IFINSignalSender::Execute_GetSignalSenderOverride(Sender);
+	
+	TSharedPtr<TArray<FFINSignalListenerEntry>, ESPMode::ThreadSafe> Snapshot = MakeShared<TArray<FFINSignalListenerEntry>, ESPMode::ThreadSafe>();
+	Snapshot->Reserve(Listeners.Num());
+	for (const FFINNetworkTrace& Listener : Listeners) {
+		Snapshot->Add(FFINSignalListenerEntry{Listener, Listener.Reverse() / SenderOverride});
+	}
+	return Snapshot;
+}
+
+void UFINSignalUtility::PruneListenerSnapshots() {
+	if (ListenerSnapshots.Num() < ListenerSnapshotsPruneCount) return;
+	for (auto Snapshot = ListenerSnapshots.CreateIterator(); Snapshot; ++Snapshot) {
+		if (!Snapshot.Key().IsValid()) Snapshot.RemoveCurrent();
+	}
+	ListenerSnapshotsPruneCount = FMath::Max(1024, ListenerSnapshots.Num() * 2);
+}
+
+void UFINSignalUtility::UpdateListenerSnapshot(UObject* Sender) {
+	FWriteScopeLock Lock(ListenerSnapshotsLock);
+	ListenerSnapshots.FindOrAdd(Sender) = BuildListenerSnapshot(Sender);
+	PruneListenerSnapshots();
+}
+
+FFINSignalListenerSnapshot UFINSignalUtility::GetListenerSnapshot(UObject* Sender) {
+	{
+		FReadScopeLock Lock(ListenerSnapshotsLock);
+		FFINSignalListenerSnapshot* Snapshot = ListenerSnapshots.Find(Sender);
+		if (Snapshot) return *Snapshot;
+	}
+	FWriteScopeLock Lock(ListenerSnapshotsLock);
+	FFINSignalListenerSnapshot* Snapshot = ListenerSnapshots.Find(Sender);
+	if (Snapshot) return *Snapshot;
+	FFINSignalListenerSnapshot NewSnapshot = BuildListenerSnapshot(Sender);
+	ListenerSnapshots.Add(Sender, NewSnapshot);
+	PruneListenerSnapshots();
+	return NewSnapshot;
+}
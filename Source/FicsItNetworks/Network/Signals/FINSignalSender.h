@@ -4,6 +4,8 @@
 #include "Interface.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "Network/FINNetworkTrace.h"
+#include "FINSignalListener.h"
+#include "Misc/ScopeRWLock.h"
 #include "FINSignalSender.generated.h"
 
 /**
@@ -32,6 +34,31 @@ UCLASS()
 class FICSITNETWORKS_API UFINSignalUtility : public UBlueprintFunctionLibrary {
 	GENERATED_BODY()
 
+private:
+	/**
+	 * The listener snapshots of all senders which emitted a signal or got listened to.
+	 * Senders without listeners have a nullptr snapshot, so emitting doesn't need to check their listeners again.
+	 */
+	static TMap<TWeakObjectPtr<UObject>, FFINSignalListenerSnapshot> ListenerSnapshots;
+	static FRWLock ListenerSnapshotsLock;
+
+	/**
+	 * The snapshot count at which the snapshots of destroyed senders get removed next.
+	 */
+	static int32 ListenerSnapshotsPruneCount;
+
+	/**
+	 * Builds the listener snapshot of the given sender from its listener list, nullptr if it has no listeners.
+	 * The snapshots have to be write locked by the caller, so concurrent updates of the same sender can't overtake each other.
+	 */
+	static FFINSignalListenerSnapshot BuildListenerSnapshot(UObject* Sender);
+
+	/**
+	 * Removes the snapshots of destroyed senders once the snapshot count doubled since the last time.
+	 * The snapshots have to be write locked by the caller.
+	 */
+	static void PruneListenerSnapshots();
+
 public:
 	/**
 	 * This functions manipulates the signal UFunctions of the given class so the signals get actually send to the listeners.
@@ -40,4 +67,40 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Network|Signals|Sender")
 	static void SetupSender(UClass* signalSender);
+
+	/**
+	 * Adds the given listener to the given signal sender and updates the listener snapshot of the sender.
+	 *
+	 * @param[in]	Sender		the signal sender you want to add the listener to
+	 * @param[in]	Listener	the trace from the sender to the listener
+	 */
+	static void AddListener(UObject* Sender, const FFINNetworkTrace& Listener);
+
+	/**
+	 * Removes the given listener from the given signal sender and updates the listener snapshot of the sender.
+	 *
+	 * @param[in]	Sender		the signal sender you want to remove the listener from
+	 * @param[in]	Listener	the trace from the sender to the listener
+	 */
+	static void RemoveListener(UObject* Sender, const FFINNetworkTrace& Listener);
+
+	/**
+	 * Rebuilds the listener snapshot of the given signal sender from its listener list.
+	 */
+	static void UpdateListenerSnapshot(UObject* Sender);
+
+	/**
+	 * Returns the current listener snapshot of the given signal sender.
+	 * Builds the snapshot if the sender doesn't have one yet (f.e. after loading).
+	 * Returns nullptr if the sender has no listeners.
+	 */
+	static FFINSignalListenerSnapshot GetListenerSnapshot(UObject* Sender);
+
+	/**
+	 * Sends the given signal to all listeners of the given signal sender.
+	 *
+	 * @param[in]	Sender	the signal sender emitting the signal
+	 * @param[in]	Signal	the signal you want to send
+	 */
+	static void BroadcastSignal(UObject* Sender, const TFINDynamicStruct<FFINSignal>& Signal);
 };
\ No newline at end of file
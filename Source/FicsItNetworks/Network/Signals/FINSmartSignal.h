@@ -5,6 +5,20 @@
 #include "Network/FINNetworkTrace.h"
 #include "FINSmartSignal.generated.h"
 
+/**
+ * Checks if the given argument types are values for the variadic smart signal constructor,
+ * a single argument array has to use the array constructor instead.
+ */
+template<typename... Ts>
+struct TFINIsSmartSignalValueList {
+	enum { Value = true };
+};
+
+template<typename T>
+struct TFINIsSmartSignalValueList<T> {
+	enum { Value = !TIsSame<typename TDecay<T>::Type, TArray<FFINAnyNetworkValue>>::Value };
+};
+
 /**
  * A signal container which uses a c++ variadic parameters list
  * to store the signal parameters.
@@ -18,10 +32,10 @@ protected:
 
 public:
 	FFINSmartSignal();
-	FFINSmartSignal(FString name, const TArray<FFINAnyNetworkValue>& args) : FFINSignal(name), Args(args) {}
+	FFINSmartSignal(FFINName name, const TArray<FFINAnyNetworkValue>& args) : FFINSignal(name), Args(args) {}
 	
-	template<typename... Ts>
-	FFINSmartSignal(FString signalName, Ts&&... args) : FFINSmartSignal(signalName, {FFINAnyNetworkValue(args)...}) {}
+	template<typename... Ts, typename = typename TEnableIf<TFINIsSmartSignalValueList<Ts...>::Value>::Type>
+	FFINSmartSignal(FFINName signalName, Ts&&... args) : FFINSmartSignal(signalName, {FFINAnyNetworkValue(args)...}) {}
 
 	bool Serialize(FArchive& Ar);
 	
@@ -1,8 +1,8 @@
 ﻿#include "FINStructSignal.h"
 
-FFINStructSignal::FFINStructSignal() : FFINSignal("NoSignal") {}
+FFINStructSignal::FFINStructSignal() : FFINSignal(TEXT("NoSignal")) {}
 
-FFINStructSignal::FFINStructSignal(const FString& Name, const TFINDynamicStruct<FFINParameterList>& Data) : FFINSignal(Name), Data(Data) {}
+FFINStructSignal::FFINStructSignal(FFINName Name, const TFINDynamicStruct<FFINParameterList>& Data) : FFINSignal(Name), Data(Data) {}
 
 bool FFINStructSignal::Serialize(FArchive& Ar) {
 	Super::Serialize(Ar);
@@ -17,7 +17,7 @@ private:
 	
 public:
 	FFINStructSignal();
-	FFINStructSignal(const FString& Name, const TFINDynamicStruct<FFINParameterList>& Data);
+	FFINStructSignal(FFINName Name, const TFINDynamicStruct<FFINParameterList>& Data);
 	
 	bool Serialize(FArchive& Ar);
 	
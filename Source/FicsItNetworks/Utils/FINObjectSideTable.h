@@ -0,0 +1,65 @@
+﻿#pragma once
+
+#include <atomic>
+
+#include "CoreMinimal.h"
+
+/**
+ * Table of slots indexed by the object index of UObjects.
+ * Allows hot code paths to look up data of an object with a single memory access,
+ * without locking or hashing.
+ * Chunks of slots get allocated with the first slot within them and are kept till the table gets destroyed,
+ * so finding slots is lock free and thread safe.
+ * Adding slots has to be synchronized by the user.
+ * Slots don't get cleared when their object gets destroyed, so users have to guard against reused object indices
+ * f.e. by checking the serial number of the object.
+ * The slot type has to be zero initializable.
+ */
+template<typename T, int32 ChunkSize = 64 * 1024, int32 ChunkCount = 1024>
+class TFINObjectSideTable {
+private:
+	std::atomic<T*> Chunks[ChunkCount];
+
+public:
+	TFINObjectSideTable() {
+		for (std::atomic<T*>& Chunk : Chunks) Chunk.store(nullptr, std::memory_order_relaxed);
+	}
+	TFINObjectSideTable(const TFINObjectSideTable&) = delete;
+	TFINObjectSideTable& operator=(const TFINObjectSideTable&) = delete;
+	~TFINObjectSideTable() {
+		for (std::atomic<T*>& Chunk : Chunks) delete[] Chunk.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Returns the slot of the given object.
+	 *
+	 * @param[in]	Object	the object you want to get the slot of
+	 * @return	the slot, nullptr if the chunk of the slot is not yet allocated
+	 */
+	T* Find(const UObjectBase* Object) const {
+		const int32 Index = static_cast<int32>(Object->GetUniqueID());
+		const int32 ChunkIndex = Index / ChunkSize;
+		if (Index < 0 || ChunkIndex >= ChunkCount) return nullptr;
+		T* Chunk = Chunks[ChunkIndex].load(std::memory_order_acquire);
+		return Chunk ? &Chunk[Index % ChunkSize] : nullptr;
+	}
+
+	/**
+	 * Returns the slot of the given object and allocates its chunk if needed.
+	 * Has to be synchronized with other calls of this function.
+	 *
+	 * @param[in]	Object	the object you want to get the slot of
+	 * @return	the slot, nullptr if the object index exceeds the table
+	 */
+	T* FindOrAdd(const UObjectBase* Object) {
+		const int32 Index = static_cast<int32>(Object->GetUniqueID());
+		const int32 ChunkIndex = Index / ChunkSize;
+		if (Index < 0 || ChunkIndex >= ChunkCount) return nullptr;
+		T* Chunk = Chunks[ChunkIndex].load(std::memory_order_acquire);
+		if (!Chunk) {
+			Chunk = new T[ChunkSize]();
+			Chunks[ChunkIndex].store(Chunk, std::memory_order_release);
+		}
+		return &Chunk[Index % ChunkSize];
+	}
+};